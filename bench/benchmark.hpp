@@ -0,0 +1,95 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+/*
+ * Minimal self-contained microbenchmark harness, in the spirit of Google Benchmark
+ *
+ * A benchmark is a function that runs its kernel for state.iterations() iterations.
+ * The harness doubles the iteration count until the run lasts at least minTime.
+ */
+namespace bench {
+
+class State {
+ public:
+  explicit State(std::size_t iterations)
+  : iterations_(iterations) {
+  }
+
+  std::size_t iterations() const { return iterations_; }
+
+ private:
+  std::size_t iterations_;
+};
+
+// Prevent the compiler from optimizing away a computed value
+template<typename T>
+inline void doNotOptimize(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Benchmark {
+  std::string name;
+  std::function<void(State&)> function;
+};
+
+class Runner {
+ public:
+  Runner()
+  : minTime_(0.2) {
+  }
+
+  void setMinTime(double minTime) { minTime_ = minTime; }
+  void setFilter(std::string filter) { filter_ = filter; }
+
+  void add(std::string name, std::function<void(State&)> function) {
+    benchmarks_.push_back(Benchmark{name, function});
+  }
+
+  void run() const {
+    std::cout << std::left << std::setw(56) << "Benchmark"
+              << std::right << std::setw(16) << "Time (ns)"
+              << std::setw(14) << "Iterations" << std::endl;
+    for (const Benchmark &b : benchmarks_) {
+      if (!filter_.empty() && b.name.find(filter_) == std::string::npos)
+        continue;
+      runOne(b);
+    }
+  }
+
+ private:
+  void runOne(const Benchmark &b) const {
+    std::size_t iterations = 1;
+    while (true) {
+      State state(iterations);
+      auto start = std::chrono::steady_clock::now();
+      b.function(state);
+      double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      if (elapsed >= minTime_ || iterations >= (1llu << 40)) {
+        std::cout << std::left << std::setw(56) << b.name
+                  << std::right << std::setw(16) << std::fixed << std::setprecision(0) << 1.0e9 * elapsed / iterations
+                  << std::setw(14) << iterations << std::endl;
+        return;
+      }
+      iterations *= 2;
+    }
+  }
+
+ private:
+  std::vector<Benchmark> benchmarks_;
+  double minTime_;
+  std::string filter_;
+};
+
+}
+
+#endif
+
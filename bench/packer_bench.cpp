@@ -0,0 +1,316 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#include "benchmark.hpp"
+
+#include "problem.hpp"
+#include "solution.hpp"
+#include "row_packer.hpp"
+#include "cut_packer.hpp"
+#include "plate_packer.hpp"
+#include "packer_front.hpp"
+#include "ordering_heuristic.hpp"
+
+#include <random>
+#include <sstream>
+#include <fstream>
+#include <cstring>
+
+/*
+ * Microbenchmarks of the packing kernels
+ *
+ * Fixtures are built from dataset instances: the sequence is the ordering of the
+ * reference solution and the plates are taken either from the instance or
+ * generated with a fixed number of random defects. Everything is seeded, so
+ * that the numbers are reproducible from one run to the next.
+ */
+
+using namespace std;
+
+#ifndef ROADEF2018_DATASET_DIR
+#define ROADEF2018_DATASET_DIR "dataset"
+#endif
+
+namespace {
+
+struct Fixture {
+  string name;
+  Problem problem;
+  vector<Item> sequence;
+  vector<Defect> defects;
+};
+
+vector<Item> readSequence(const Problem &problem, const string &prefix) {
+  vector<Item> sequence;
+  ifstream f(prefix + "_solution.csv");
+  if (f.good()) {
+    for (int id : Solution::readOrdering(prefix + "_solution.csv"))
+      sequence.push_back(problem.items()[id]);
+  }
+  else {
+    for (const vector<Item> &stack : problem.stackItems())
+      sequence.insert(sequence.end(), stack.begin(), stack.end());
+  }
+  return sequence;
+}
+
+vector<Defect> randomDefects(int nDefects, int seed) {
+  // Same distribution as the small defects of utils/generator.py
+  mt19937 rgen(seed);
+  uniform_int_distribution<int> sizeDist(1, 20);
+  vector<Defect> defects;
+  for (int i = 0; i < nDefects; ++i) {
+    int w = sizeDist(rgen);
+    int h = sizeDist(rgen);
+    int x = uniform_int_distribution<int>(0, Params::widthPlates - w)(rgen);
+    int y = uniform_int_distribution<int>(0, Params::heightPlates - h)(rgen);
+    Defect defect(x, y, w, h);
+    defect.id = i;
+    defect.plateId = 0;
+    defects.push_back(defect);
+  }
+  return defects;
+}
+
+// Replace the defects of the first plate with the given ones
+Problem withPlateDefects(const Problem &problem, const vector<Defect> &plateDefects) {
+  vector<Defect> defects;
+  for (Defect d : problem.defects()) {
+    if (d.plateId != 0) defects.push_back(d);
+  }
+  defects.insert(defects.end(), plateDefects.begin(), plateDefects.end());
+  return Problem(problem.items(), defects);
+}
+
+vector<Fixture> buildFixtures(const string &datasetDir) {
+  vector<Fixture> fixtures;
+  for (string instance : {"A/A5", "B/B5", "G/G2"}) {
+    string prefix = datasetDir + "/" + instance;
+    Problem problem = Problem::read(prefix + "_batch.csv", prefix + "_defects.csv");
+    vector<Item> sequence = readSequence(problem, prefix);
+    string name = instance.substr(instance.find('/') + 1);
+
+    vector<Defect> defects = problem.plateDefects()[0];
+    fixtures.push_back(Fixture{name + "/plate0", problem, sequence, defects});
+
+    if (instance != "A/A5") continue;
+    for (int nDefects : {0, 4, 16, 64}) {
+      vector<Defect> defects = randomDefects(nDefects, nDefects);
+      stringstream ss;
+      ss << name << "/defects" << nDefects;
+      fixtures.push_back(Fixture{ss.str(), withPlateDefects(problem, defects), sequence, defects});
+    }
+  }
+  return fixtures;
+}
+
+string optionName(PackingOption option) {
+  switch (option) {
+    case PackingOption::Approximate:
+      return "Approximate";
+    case PackingOption::Exact:
+      return "Exact";
+    default:
+      return "Diagnose";
+  }
+}
+
+// Diagnostic runs report to cout; keep the benchmark table readable
+struct SilenceOutput {
+  SilenceOutput() : saved(cout.rdbuf(nullptr)) {}
+  ~SilenceOutput() { cout.rdbuf(saved); }
+  streambuf *saved;
+};
+
+// The kernels are measured without the cut cache, that would only return the results of the previous iterations
+SolverParams kernelParams() {
+  SolverParams params;
+  params.cacheCuts = false;
+  return params;
+}
+
+// Each kernel cycles through the same start positions in the sequence
+vector<int> startPositions(const Fixture &f) {
+  const int nStarts = 8;
+  vector<int> starts;
+  for (int i = 0; i < nStarts; ++i)
+    starts.push_back(i * (int) f.sequence.size() / (2 * nStarts));
+  return starts;
+}
+
+const int rowWidth = Params::maxXX;
+const int rowHeight = 1000;
+const int cutWidth = 2000;
+
+// First coordinate after the one given where a cut does not cross a defect
+int admissibleCut(int coord, const vector<Defect> &defects, bool vertical) {
+  for (bool found = true; found; ) {
+    found = false;
+    for (const Defect &d : defects) {
+      if (vertical ? d.intersectsVerticalLine(coord) : d.intersectsHorizontalLine(coord)) {
+        coord = (vertical ? d.maxX() : d.maxY()) + 1;
+        found = true;
+      }
+    }
+  }
+  return coord;
+}
+
+void registerRowBenchmarks(bench::Runner &runner, const Fixture &f) {
+  int maxX = admissibleCut(rowWidth, f.defects, true);
+  int maxY = admissibleCut(rowHeight, f.defects, false);
+  Rectangle row = Rectangle::FromCoordinates(0, 0, maxX, maxY);
+  vector<int> starts = startPositions(f);
+
+  runner.add("RowPacker::count/" + f.name, [&f, row, starts](bench::State &state) {
+    RowPacker packer(f.sequence, kernelParams());
+    for (size_t i = 0; i < state.iterations(); ++i) {
+      bench::doNotOptimize(packer.count(row, starts[i % starts.size()], f.defects));
+    }
+  });
+  for (PackingOption option : {PackingOption::Approximate, PackingOption::Exact}) {
+    SolverParams params = kernelParams();
+    params.rowPacking = option;
+    runner.add("RowPacker::run<" + optionName(option) + ">/" + f.name, [&f, row, starts, params](bench::State &state) {
+      RowPacker packer(f.sequence, params);
+      for (size_t i = 0; i < state.iterations(); ++i) {
+        bench::doNotOptimize(packer.run(row, starts[i % starts.size()], f.defects));
+      }
+    });
+  }
+}
+
+void registerCutBenchmarks(bench::Runner &runner, const Fixture &f) {
+  int maxX = admissibleCut(cutWidth, f.defects, true);
+  Rectangle cut = Rectangle::FromCoordinates(0, 0, maxX, Params::heightPlates);
+  vector<int> starts = startPositions(f);
+
+  runner.add("CutPacker::count/" + f.name, [&f, cut, starts](bench::State &state) {
+    CutPacker packer(f.sequence, kernelParams());
+    for (size_t i = 0; i < state.iterations(); ++i) {
+      bench::doNotOptimize(packer.count(cut, starts[i % starts.size()], f.defects));
+    }
+  });
+  SolverParams exactParams = kernelParams();
+  exactParams.cutPacking = PackingOption::Exact;
+  runner.add("CutPacker::count<Exact>/" + f.name, [&f, cut, starts, exactParams](bench::State &state) {
+    CutPacker packer(f.sequence, exactParams);
+    for (size_t i = 0; i < state.iterations(); ++i) {
+      bench::doNotOptimize(packer.count(cut, starts[i % starts.size()], f.defects));
+    }
+  });
+  runner.add("CutPacker::run/" + f.name, [&f, cut, starts](bench::State &state) {
+    CutPacker packer(f.sequence, kernelParams());
+    for (size_t i = 0; i < state.iterations(); ++i) {
+      bench::doNotOptimize(packer.run(cut, starts[i % starts.size()], f.defects));
+    }
+  });
+}
+
+void registerPlateBenchmarks(bench::Runner &runner, const Fixture &f, bool exact) {
+  vector<int> starts = startPositions(f);
+  vector<PackingOption> options = {PackingOption::Approximate};
+  if (exact) {
+    options.push_back(PackingOption::Exact);
+    options.push_back(PackingOption::Diagnose);
+  }
+  for (PackingOption option : options) {
+    SolverParams params = kernelParams();
+    params.platePacking = option;
+    runner.add("PlatePacker::run<" + optionName(option) + ">/" + f.name, [&f, starts, params](bench::State &state) {
+      SilenceOutput silence;
+      PlatePacker packer(f.problem, f.sequence, params);
+      for (size_t i = 0; i < state.iterations(); ++i) {
+        bench::doNotOptimize(packer.run(0, starts[i % starts.size()]));
+      }
+    });
+  }
+  // Same plates packed again, with all defect-free cuts already in the cache
+  runner.add("PlatePacker::run<Cached>/" + f.name, [&f, starts](bench::State &state) {
+    PlatePacker packer(f.problem, f.sequence, SolverParams());
+    for (size_t i = 0; i < state.iterations(); ++i) {
+      bench::doNotOptimize(packer.run(0, starts[i % starts.size()]));
+    }
+  });
+}
+
+void registerOrderingBenchmarks(bench::Runner &runner, const Fixture &f) {
+  for (int chunkSize : {4, 256}) {
+    stringstream ss;
+    ss << "OrderingHeuristic::orderShuffle/chunk" << chunkSize << "/" << f.name;
+    runner.add(ss.str(), [&f, chunkSize](bench::State &state) {
+      mt19937 rgen(chunkSize);
+      for (size_t i = 0; i < state.iterations(); ++i) {
+        bench::doNotOptimize(OrderingHeuristic::orderShuffle(f.problem, rgen, chunkSize).size());
+      }
+    });
+  }
+}
+
+void registerFrontBenchmarks(bench::Runner &runner) {
+  for (int frontSize : {8, 64}) {
+    // Random candidate elements, most of them dominated as in the packers
+    mt19937 rgen(frontSize);
+    vector<PackerFront::Element> elements;
+    for (int i = 0; i < 1024; ++i) {
+      int end = uniform_int_distribution<int>(1, Params::widthPlates)(rgen);
+      int value = end * frontSize / Params::widthPlates + uniform_int_distribution<int>(0, 2)(rgen);
+      elements.emplace_back(end - 1, end, value, 0);
+    }
+    stringstream ss;
+    ss << "PackerFront::insert/values" << frontSize;
+    runner.add(ss.str(), [elements](bench::State &state) {
+      PackerFront front;
+      for (size_t i = 0; i < state.iterations(); ++i) {
+        if (i % elements.size() == 0) {
+          front.clear();
+          front.init(0, 0);
+        }
+        front.insert(elements[i % elements.size()]);
+      }
+      bench::doNotOptimize(front.size());
+    });
+  }
+}
+
+}
+
+int main(int argc, char **argv) {
+  bench::Runner runner;
+  string datasetDir = ROADEF2018_DATASET_DIR;
+  bool exact = false;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--filter") && i + 1 < argc) {
+      runner.setFilter(argv[++i]);
+    }
+    else if (!strcmp(argv[i], "--min-time") && i + 1 < argc) {
+      runner.setMinTime(stod(argv[++i]));
+    }
+    else if (!strcmp(argv[i], "--dataset") && i + 1 < argc) {
+      datasetDir = argv[++i];
+    }
+    else if (!strcmp(argv[i], "--exact")) {
+      exact = true;
+    }
+    else {
+      cerr << "Usage: " << argv[0] << " [--filter SUBSTRING] [--min-time SECONDS] [--dataset DIR] [--exact]" << endl;
+      cerr << "  --exact also runs the exact and diagnostic plate packings, which take seconds per call" << endl;
+      return 1;
+    }
+  }
+
+  try {
+    vector<Fixture> fixtures = buildFixtures(datasetDir);
+    for (const Fixture &f : fixtures) registerRowBenchmarks(runner, f);
+    for (const Fixture &f : fixtures) registerCutBenchmarks(runner, f);
+    for (const Fixture &f : fixtures) registerPlateBenchmarks(runner, f, exact);
+    for (const Fixture &f : fixtures) {
+      if (f.name.find("/plate0") != string::npos) registerOrderingBenchmarks(runner, f);
+    }
+    registerFrontBenchmarks(runner);
+    runner.run();
+  } catch (const exception &e) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+  return 0;
+}
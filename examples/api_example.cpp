@@ -0,0 +1,55 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#include "roadef2018.hpp"
+
+#include <iostream>
+#include <atomic>
+
+using namespace std;
+
+/*
+ * Solve a small instance built in memory through the library API
+ */
+int main() {
+  vector<Item> items;
+  for (int i = 0; i < 40; ++i) {
+    Item item;
+    item.id = i;
+    item.width = 300 + 50 * (i % 7);
+    item.height = 500 + 100 * (i % 5);
+    item.stack = i % 4;
+    item.sequence = i / 4;
+    items.push_back(item);
+  }
+
+  vector<Defect> defects;
+  Defect defect(1000, 1000, 10, 10);
+  defect.id = 0;
+  defect.plateId = 0;
+  defects.push_back(defect);
+
+  Problem problem(items, defects);
+
+  SolverParams params;
+  params.timeLimit = 1.0;
+
+  // Stop the search early after a few improvements
+  CancellationToken token;
+  SolverCallbacks callbacks;
+  callbacks.cancellation = &token;
+  atomic<int> nImprovements(0);
+  callbacks.onImprovement = [&](const Solution &) {
+    if (++nImprovements >= 10) token.cancel();
+  };
+
+  Solution solution = Solver::run(problem, params, Solution(), callbacks);
+
+  if (SolutionChecker::nViolations(problem, solution) != 0) {
+    cerr << "Invalid solution" << endl;
+    return 1;
+  }
+  cout << solution.nItems() << " items placed on " << solution.nPlates() << " plates, ";
+  cout << SolutionChecker::evalPercentDensity(problem, solution) << "% density, ";
+  cout << nImprovements << " improvements" << endl;
+  return solution.nItems() == (int) items.size() ? 0 : 1;
+}
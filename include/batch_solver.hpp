@@ -0,0 +1,84 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#ifndef BATCH_SOLVER_HPP
+#define BATCH_SOLVER_HPP
+
+#include "problem.hpp"
+#include "solution.hpp"
+#include "solver_params.hpp"
+#include "lower_bound.hpp"
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+struct BatchInstance {
+  std::string name;
+  std::string batchFile;
+  std::string defectFile;
+  std::string solutionFile;
+};
+
+/*
+ * Solve many instances in a single process, sharing one pool of worker threads.
+ *
+ * The time limit is a budget for the whole batch. Each instance is solved in
+ * several short runs, continuing from its best solution; instances that are
+ * still improving are given a larger share of the remaining time.
+ */
+class BatchSolver {
+ public:
+  static std::vector<BatchInstance> readManifest(std::string manifest);
+  static void run(const std::vector<BatchInstance> &instances, SolverParams params, bool permissive=false);
+
+ private:
+  struct InstanceState {
+    Problem problem;
+    Solution solution;
+    double mapped;
+    double density;
+    double densityBound;
+    double timeSpent;
+    int nRuns;
+    int nStalled;
+    bool busy;
+
+    bool boundReached() const { return mapped >= 100.0 && density >= densityBound; }
+
+    InstanceState(Problem problem)
+    : problem(problem)
+    , mapped(0.0)
+    , density(0.0)
+    , densityBound(LowerBound::percentDensity(problem))
+    , timeSpent(0.0)
+    , nRuns(0)
+    , nStalled(0)
+    , busy(false) {
+    }
+  };
+
+  BatchSolver(const std::vector<BatchInstance> &instances, SolverParams params, bool permissive);
+  void run();
+  void runWorker(std::size_t nThreads);
+  int pickInstance() const;
+  double sliceLength() const;
+  double remainingTime() const;
+  void solveInstance(int ind, const Deadline &deadline, std::size_t nThreads);
+  void finalReport() const;
+
+ private:
+  const std::vector<BatchInstance> &instances_;
+  SolverParams params_;
+  std::vector<InstanceState> states_;
+  std::size_t nWorkers_;
+
+  std::mutex mutex_;
+  // Signaled whenever an instance stops being busy
+  std::condition_variable released_;
+  std::chrono::time_point<std::chrono::steady_clock> startTime_;
+};
+
+#endif
+
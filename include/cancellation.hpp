@@ -0,0 +1,64 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#ifndef CANCELLATION_HPP
+#define CANCELLATION_HPP
+
+#include <atomic>
+#include <chrono>
+
+/*
+ * Flag set by the caller to interrupt a running solver, from any thread
+ */
+class CancellationToken {
+ public:
+  CancellationToken()
+  : cancelled_(false) {
+  }
+
+  void cancel() {
+    cancelled_.store(true, std::memory_order_relaxed);
+  }
+
+  bool cancelled() const {
+    return cancelled_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<bool> cancelled_;
+};
+
+/*
+ * Monotonic deadline, optionally tied to a cancellation token
+ *
+ * Cheap enough to be polled inside the packing algorithms.
+ */
+class Deadline {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  Deadline()
+  : end_(Clock::time_point::max())
+  , token_(nullptr) {
+  }
+
+  Deadline(Clock::time_point end, const CancellationToken *token=nullptr)
+  : end_(end)
+  , token_(token) {
+  }
+
+  bool expired() const {
+    if (token_ != nullptr && token_->cancelled())
+      return true;
+    return Clock::now() >= end_;
+  }
+
+  Clock::time_point end() const { return end_; }
+  const CancellationToken *token() const { return token_; }
+
+ private:
+  Clock::time_point end_;
+  const CancellationToken *token_;
+};
+
+#endif
+
@@ -0,0 +1,39 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#ifndef COW_HPP
+#define COW_HPP
+
+#include <memory>
+#include <utility>
+
+/*
+ * Value shared between copies, duplicated only when written to
+ *
+ * Copying only copies a reference-counted pointer: solutions that differ by a
+ * few plates share all the others. Reads go through the conversion to const T&
+ * or operator->; mut() gives a modifiable value, copied first if it is shared.
+ */
+template<typename T>
+class Cow {
+ public:
+  Cow() : ptr_(std::make_shared<T>()) {}
+  Cow(const T &value) : ptr_(std::make_shared<T>(value)) {}
+  Cow(T &&value) : ptr_(std::make_shared<T>(std::move(value))) {}
+
+  const T &operator*() const { return *ptr_; }
+  const T *operator->() const { return ptr_.get(); }
+  operator const T&() const { return *ptr_; }
+
+  T &mut() {
+    if (ptr_.use_count() > 1) ptr_ = std::make_shared<T>(*ptr_);
+    return *ptr_;
+  }
+
+  bool shares(const Cow &other) const { return ptr_ == other.ptr_; }
+
+ private:
+  std::shared_ptr<T> ptr_;
+};
+
+#endif
+
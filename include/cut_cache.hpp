@@ -0,0 +1,58 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#ifndef CUT_CACHE_HPP
+#define CUT_CACHE_HPP
+
+#include "problem.hpp"
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+/*
+ * Process-wide cache of the counts of cuts without defects
+ *
+ * Such a count only depends on the width of the cut and on the dimensions of the
+ * items examined by the packing, so it is shared by all plates, sequences,
+ * instances and threads. Lookups never lock: each slot is protected by a
+ * sequence number, and an insertion is dropped if another thread is writing
+ * the same slot.
+ */
+class CutCache {
+ public:
+  struct Entry {
+    int nExamined;
+    int nItems;
+    int maxUsedX;
+    bool tightX;
+    int minWidth;
+    int maxWidth;
+  };
+
+  static CutCache &global();
+
+  bool lookup(const std::vector<Item> &sequence, int start, int width, Entry &entry) const;
+  void insert(const std::vector<Item> &sequence, int start, int width, const Entry &entry);
+  void clear();
+
+ private:
+  CutCache(int logSize);
+
+  struct Slot {
+    std::atomic<std::uint32_t> version;
+    std::atomic<std::uint64_t> key;
+    std::atomic<std::uint64_t> data;
+  };
+
+  std::size_t slotIndex(const std::vector<Item> &sequence, int start, int width) const;
+  static std::uint64_t windowKey(const std::vector<Item> &sequence, int start, int nExamined, int width);
+  static std::uint64_t pack(const Entry &entry);
+  static Entry unpack(std::uint64_t data);
+
+ private:
+  std::size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+};
+
+#endif
+
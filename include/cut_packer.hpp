@@ -23,16 +23,31 @@ class CutPacker : Packer {
     }
   };
 
+  // The cut description for all maxX in [minMaxX, maxMaxX]
+  struct CutWidthRange {
+    int minMaxX;
+    int maxMaxX;
+    CutDescription description;
+
+    CutWidthRange() {
+      minMaxX = 1;
+      maxMaxX = 0;
+    }
+  };
+
  public:
   CutPacker(const std::vector<Item> &sequence, SolverParams options);
   CutSolution run(Rectangle cut, int start, const std::vector<Defect> &defects);
   CutDescription count(Rectangle cut, int start, const std::vector<Defect> &defects);
+  // Same as count, with the range of cut ends giving the same result
+  CutWidthRange countWidthRange(Rectangle cut, int start, const std::vector<Defect> &defects);
 
  private:
   CutSolution runApproximate();
   CutSolution runExact();
   CutSolution runDiagnostic();
   CutDescription countApproximate();
+  CutDescription countCached();
   CutDescription countExact();
   CutDescription countDiagnostic();
   void reportFront(const std::vector<int> &front, const std::vector<int> &prev) const;
@@ -40,21 +55,35 @@ class CutPacker : Packer {
   void setup(Rectangle cut, int start, const std::vector<Defect> &defects);
   void commonApproximate();
   void commonExact();
+  template<bool HasDefects>
+  void fillFront();
+  template<bool HasDefects>
   void propagate(int previousFront, int beginCoord);
   void propagateBreakpoints(int after);
 
   CutSolution backtrack();
   CutDescription countBacktrack();
 
+  template<bool HasDefects=true>
   RowPacker::RowDescription countRow(int start, int minY, int maxY);
+  bool rowHasDefects(int minY, int maxY) const;
+  int computeRowProfile(int start, int minY, std::vector<RowPacker::RowProfileStep> &profile);
+  RowPacker::RowDescription countRowFromProfile(const std::vector<RowPacker::RowProfileStep> &profile, int profileMaxY, int start, int minY, int maxY);
   RowSolution packRow(int start, int minY, int maxY);
 
+  template<bool HasDefects=true>
   bool isAdmissibleCutLine(int y) const;
 
  private:
   PackerFront front_;
   RowPacker rowPacker_;
   std::vector<int> slices_;
+
+  // Cut widths where the rows counted since the setup are unchanged
+  int minWidth_;
+  int maxWidth_;
+  // End of the items examined by the rows counted since the setup
+  int maxExamined_;
 };
 
 #endif
@@ -17,7 +17,7 @@ class IOProblem {
   std::vector<Item> readItems();
   std::vector<Defect> readDefects();
 
-  void writeParams();
+  void writeParams(const Problem &pb);
   void writeItems(const std::vector<Item> &items);
   void writeDefects(const std::vector<Defect> &defects);
 
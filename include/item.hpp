@@ -3,10 +3,13 @@
 #ifndef ITEM_HPP
 #define ITEM_HPP
 
+#include <cstdint>
+
+// Dimensions are bounded by the plate size, so that an item fits in 16 bytes
 struct Item {
   int id;
-  int width;
-  int height;
+  std::int16_t width;
+  std::int16_t height;
   int stack;
   int sequence;
 
@@ -16,4 +19,3 @@ struct Item {
 };
 
 #endif
-
@@ -0,0 +1,31 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#ifndef LOWER_BOUND_HPP
+#define LOWER_BOUND_HPP
+
+#include "problem.hpp"
+
+/*
+ * Lower bounds on the area used by a solution that cuts all the items
+ *
+ * The used area covers the full plates and the last plate up to its last 1-cut,
+ * so the bounds are on the used length, counted along the plates placed end to end:
+ *   - the items fit in the area it covers, minus the defects;
+ *   - each item spans at least its smallest dimension, and a 1-cut at least minXX;
+ *   - items higher than half a plate in both orientations are side by side.
+ */
+class LowerBound {
+ public:
+  static long long areaUsage(const Problem &problem);
+  // Best density a solution can reach, in percent
+  static double percentDensity(const Problem &problem);
+  // Gap between the area used by the solution and the bound, as a percentage of the area used
+  static double percentGap(const Problem &problem, long long areaUsage);
+
+ private:
+  static long long usedLength(const Problem &problem);
+  static long long defectArea(const std::vector<Defect> &defects, int maxX);
+};
+
+#endif
+
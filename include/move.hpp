@@ -31,30 +31,26 @@ class Move {
   }
 
  protected:
-  std::vector<std::vector<Item> > extractItemItems(const Solution&) const;
-  std::vector<std::vector<Item> > extractRowItems(const Solution&) const;
-  std::vector<std::vector<Item> > extractCutItems(const Solution&) const;
-  std::vector<std::vector<Item> > extractPlateItems(const Solution&) const;
-
-  std::vector<ItemSolution> extractItems(const Solution&) const;
-  std::vector<RowSolution> extractRows(const Solution&) const;
-  std::vector<CutSolution> extractCuts(const Solution&) const;
-  std::vector<PlateSolution> extractPlates(const Solution&) const;
-
-  int plateIdOfRow(int rowId) const;
-  int plateIdOfCut(int cutId) const;
-
-  Solution mergeRepairRun(const std::vector<std::vector<Item> > &sequence);
-  Solution runSequence(const std::vector<Item> &sequence);
-
-  std::vector<Item> mergeSequence(const std::vector<std::vector<Item> > &sequence);
-  void repairSequence(std::vector<Item> &sequence) const;
-  bool sequenceValid(const std::vector<Item> &sequence) const;
-  void checkSequenceValid(const std::vector<Item> &sequence) const;
+  // Moves permute blocks of the incumbent's sequence, given by their offsets in the view
+  static std::vector<int> blockOrder(const std::vector<int> &offsets);
+  Solution mergeRepairRun(const std::vector<int> &offsets, const std::vector<int> &order);
+  Solution runSequence(const std::vector<int> &sequence);
+  // Same, when the sequence only differs from the incumbent's within [begin, end)
+  Solution runSequence(const std::vector<int> &sequence, int begin, int end);
+  Solution runValidSequence(const std::vector<int> &sequence, int begin, int end);
+  std::uint64_t sequenceHash(const std::vector<int> &sequence, int begin, int end) const;
+
+  // Sequences are given by item ids; items are only copied for the packing itself
+  std::vector<int> mergeSequence(const std::vector<int> &offsets, const std::vector<int> &order) const;
+  void repairSequence(std::vector<int> &sequence) const;
+  void repairSequence(std::vector<int> &sequence, int begin, int end) const;
+  bool sequenceValid(const std::vector<int> &sequence) const;
+  void checkSequenceValid(const std::vector<int> &sequence) const;
   Solution accept(const Solution &incumbent);
 
   const Problem& problem() const { return solver_->problem_; }
   const Solution& solution() const { return solver_->solution_; }
+  const SolutionView& view() const { return solver_->view_; }
   const SolverParams& params() const { return solver_->params_; }
 
   double bestMapped  () { return solver_->bestMapped_; }
@@ -71,8 +67,15 @@ class Move {
   std::size_t nPrunedPlates_;
   std::size_t nDifferentPlates_;
 
+  // Hash of the last sequence packed by this thread, or 0 if none; read by the solver after each move
+  static thread_local std::uint64_t evaluatedHash_;
+  // Whether the last move of this thread was skipped, its sequence being already known
+  static thread_local bool skippedKnown_;
+
  public:
   const Solver *solver_;
+  // Name of the move's spans in the traces
+  const char *traceName_;
 
   friend class Solver;
 };
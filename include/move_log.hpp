@@ -0,0 +1,38 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#ifndef MOVE_LOG_HPP
+#define MOVE_LOG_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/*
+ * Binary log of the moves run by the solver, to replay them later
+ *
+ * When recording, each move draws its random numbers from a generator seeded
+ * by the run's seed and the move index, so that a record only needs the index,
+ * the move picked, the batch it was evaluated in and its outcome. Moves of the
+ * same batch were evaluated from the same solution.
+ */
+struct MoveRecord {
+  std::uint64_t index;
+  std::uint32_t batch;
+  // Position of the move among the initializers then the moves of the solver
+  std::uint16_t move;
+  std::uint8_t status;
+  // The move was not evaluated, its sequence being already known
+  std::uint8_t skipped;
+};
+
+struct MoveLog {
+  std::uint64_t seed;
+  std::uint64_t nItems;
+  std::vector<MoveRecord> records;
+
+  void write(const std::string &fileName) const;
+  static MoveLog read(const std::string &fileName);
+};
+
+#endif
+
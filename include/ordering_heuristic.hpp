@@ -22,13 +22,16 @@ class OrderingHeuristic {
   void takeFirstStackElement(int stackInd);
   void takeFromRandomStack();
   void takeFromBestStack();
-  int wasteEstimate(int h1, int w1, int h2, int w2) const;
-  int wasteEstimate(const Item& item1, const Item& item2) const;
+  void computeWastes(const Item &item);
 
  private:
   std::vector<Item> before_;
   std::vector<Item> after_;
   std::vector<std::vector<Item> > leftover_;
+  // Dimensions of the next item of each leftover stack, for the vectorized waste computation
+  std::vector<int> topWidths_;
+  std::vector<int> topHeights_;
+  std::vector<int> wastes_;
 
   std::vector<Item> ordering_;
 
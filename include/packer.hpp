@@ -6,6 +6,7 @@
 #include "problem.hpp"
 #include "solution.hpp"
 #include "solver_params.hpp"
+#include "cancellation.hpp"
 
 class Packer {
  protected:
@@ -23,6 +24,10 @@ class Packer {
     return defects_.size();
   }
 
+  bool cancelled() const {
+    return options_.deadline != nullptr && options_.deadline->expired();
+  }
+
   void init(Rectangle region, int start, const std::vector<Defect> &defects) {
     region_ = region;
     start_ = start;
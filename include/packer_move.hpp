@@ -7,13 +7,13 @@
 
 class PackerMove : public Move {
  protected:
-  void sequenceInsert  (std::vector<Item> &sequence, std::mt19937 &rgen, const std::vector<std::vector<Item> > &all, int subseqId, int totalArea);
-  void sequenceShuffle (std::vector<Item> &sequence, std::mt19937 &rgen, const std::vector<std::vector<Item> > &all, int subseqId, int totalArea);
-  std::vector<Item> recreateFullSequence(const std::vector<Item> &newSubseq, const std::vector<std::vector<Item> > &all, int id);
+  void sequenceInsert  (std::vector<int> &sequence, std::mt19937 &rgen, const std::vector<int> &offsets, int subseqId, int totalArea);
+  void sequenceShuffle (std::vector<int> &sequence, std::mt19937 &rgen, const std::vector<int> &offsets, int subseqId, int totalArea);
+  std::vector<int> recreateFullSequence(const std::vector<int> &newSubseq, const std::vector<int> &offsets, int id);
 
-  Solution runPackRow(Rectangle targetRow, const std::vector<Item> &sequence, const std::vector<std::vector<Item> > &allRows, int rowId);
-  Solution runPackCut(Rectangle targetCut, const std::vector<Item> &sequence, const std::vector<std::vector<Item> > &allCuts, int cutId);
-  Solution runPackPlate(Rectangle targetPlate, const std::vector<Item> &sequence, const std::vector<std::vector<Item> > &allPlates, int plateId);
+  Solution runPackRow(Rectangle targetRow, const std::vector<int> &sequence, const std::vector<int> &rowOffsets, int rowId);
+  Solution runPackCut(Rectangle targetCut, const std::vector<int> &sequence, const std::vector<int> &cutOffsets, int cutId);
+  Solution runPackPlate(Rectangle targetPlate, const std::vector<int> &sequence, const std::vector<int> &plateOffsets, int plateId);
 };
 
 struct PackRowInsert : PackerMove {
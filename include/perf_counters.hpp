@@ -0,0 +1,62 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <atomic>
+#include <cstdint>
+
+/*
+ * Hardware counters of the packing kernels, read with perf_event_open on Linux
+ *
+ * Each thread opens its own group of counters (cycles, instructions, cache and
+ * branch misses, user space only) at its first measure, accumulates the counts
+ * of each kind of kernel and adds them to the totals when it exits. The counts
+ * of a kernel include the kernels it calls. If the counters cannot be opened,
+ * because of the system, perf_event_paranoid or a virtual machine without PMU,
+ * nothing is measured and the report says why.
+ */
+class PerfCounters {
+ public:
+  enum Kind {
+    RowCount,
+    CutCount,
+    PlateRun,
+    Checker,
+    NKinds
+  };
+  static const int nCounters = 4;
+
+  static void enable();
+  static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+  // Totals of the threads that exited and of the calling thread
+  static void report();
+
+  class Scope {
+   public:
+    explicit Scope(Kind kind)
+    : kind_(kind)
+    , active_(enabled() && read(begin_)) {
+    }
+    ~Scope() {
+      if (active_) add(kind_, begin_);
+    }
+    Scope(const Scope&) = delete;
+    Scope &operator=(const Scope&) = delete;
+
+   private:
+    Kind kind_;
+    bool active_;
+    std::uint64_t begin_[nCounters];
+  };
+
+ private:
+  static bool read(std::uint64_t *values);
+  static void add(Kind kind, const std::uint64_t *begin);
+
+ private:
+  static std::atomic<bool> enabled_;
+};
+
+#endif
+
@@ -23,13 +23,18 @@ class PlatePacker : Packer {
   void reportFront(const std::vector<int> &front, const std::vector<int> &prev) const;
 
   void setup(int plateId, int start);
+  template<bool HasDefects>
+  void fillFront();
+  template<bool HasDefects>
   void propagate(int previousFront, int beginCoord);
   void propagateBreakpoints(int after);
   PlateSolution backtrack();
 
   CutPacker::CutDescription countCut(int start, int minX, int maxX);
+  CutPacker::CutWidthRange countCutWidthRange(int start, int minX, int maxX);
   CutSolution packCut(int start, int minX, int maxX);
 
+  template<bool HasDefects=true>
   bool isAdmissibleCutLine(int x) const;
   int findCuttingPositionTowards(int endPos) const;
   void insertInFront(int begin, int end, int totalItems, int previous);
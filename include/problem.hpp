@@ -14,26 +14,37 @@ class Solution;
 
 class Problem {
  public:
-  Problem(std::vector<Item> items, std::vector<Defect> defects);
+  // Item ids must be their index in the vector and stacks must be numbered from 0
+  // There are at least nPlates plates, more if some defects lie further
+  Problem(std::vector<Item> items, std::vector<Defect> defects, int nPlates = Params::nPlates);
 
   static Problem read(std::string nameItems, std::string nameDefects = std::string(), bool permissive=false);
   void write(std::string nameItems, std::string nameDefects = std::string(), std::string nameParams = std::string()) const;
 
   const std::vector<Item>& items() const{ return items_; }
   const std::vector<std::vector<Item> >& stackItems() const { return stackItems_; }
+  std::vector<Item> itemSequence(const std::vector<int> &ids) const;
+
+  // Items with the same dimensions are interchangeable in a sequence; classes are numbered from 0
+  const std::vector<int>& itemClasses() const { return itemClasses_; }
+  int nItemClasses() const { return nItemClasses_; }
 
   const std::vector<Defect>& defects() const { return defects_; }
   const std::vector<std::vector<Defect> >& plateDefects() const { return plateDefects_; }
+  int nPlates() const { return plateDefects_.size(); }
 
   void checkConsistency() const;
 
  private:
   void buildSequences();
-  void buildPlates();
+  void buildClasses();
+  void buildPlates(int nPlates);
 
  private:
   std::vector<Item> items_;
   std::vector<std::vector<Item> > stackItems_;
+  std::vector<int> itemClasses_;
+  int nItemClasses_;
 
   std::vector<Defect> defects_;
   std::vector<std::vector<Defect> > plateDefects_;
@@ -0,0 +1,50 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#ifndef PROFILE_HPP
+#define PROFILE_HPP
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <ctime>
+#include <cstdint>
+
+/*
+ * Anytime profile of a run: the quality of the solution after each improvement
+ *
+ * Times are counted from the creation of the profile; the CPU time is the one
+ * of the whole process, all threads included. The last point marks the end of
+ * the run; its quality holds until the time limit, which is written with the
+ * points since the run stops slightly before it.
+ */
+struct ProfilePoint {
+  double wallTime;
+  double cpuTime;
+  // Moves attempted, or rounds for the window solver
+  std::uint64_t nMoves;
+  double mapped;
+  double density;
+  std::string move;
+};
+
+class Profile {
+ public:
+  Profile();
+
+  void add(std::uint64_t nMoves, double mapped, double density, const std::string &move);
+  const std::vector<ProfilePoint> &points() const { return points_; }
+
+  // JSON if the name ends with .json, CSV otherwise
+  void write(const std::string &fileName, double timeLimit) const;
+
+ private:
+  void writeCsv(std::ostream &s, double timeLimit) const;
+  void writeJson(std::ostream &s, double timeLimit) const;
+
+ private:
+  std::chrono::time_point<std::chrono::steady_clock> startTime_;
+  std::clock_t startClock_;
+  std::vector<ProfilePoint> points_;
+};
+
+#endif
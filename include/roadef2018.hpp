@@ -0,0 +1,22 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#ifndef ROADEF2018_HPP
+#define ROADEF2018_HPP
+
+/*
+ * Public API of the roadef2018 library
+ *
+ * Build a Problem from its items and defects, call Solver::run and use the
+ * returned Solution; SolutionChecker evaluates it. No file is involved.
+ */
+
+#include "params.hpp"
+#include "item.hpp"
+#include "defect.hpp"
+#include "problem.hpp"
+#include "solution.hpp"
+#include "solver_params.hpp"
+#include "solver.hpp"
+#include "solution_checker.hpp"
+
+#endif
@@ -27,10 +27,34 @@ class RowPacker : Packer {
     }
   };
 
+  // The row description for all maxY in ]minMaxY, maxMaxY]
+  struct RowProfileStep {
+    int minMaxY;
+    int maxMaxY;
+    RowDescription description;
+  };
+
+  // The row description for all row widths in [minWidth, maxWidth], with maxUsedX relative to the left of the row
+  struct RowWidthRange {
+    int minWidth;
+    int maxWidth;
+    RowDescription description;
+
+    RowWidthRange() {
+      minWidth = 1;
+      maxWidth = 0;
+    }
+  };
+
  public:
   RowPacker(const std::vector<Item> &sequence, SolverParams options);
   RowSolution run(Rectangle row, int start, const std::vector<Defect> &defects);
   RowDescription count(Rectangle row, int start, const std::vector<Defect> &defects);
+  // Descriptions for all maxY in ]row.minY(), row.maxY()] in a single pass; rows without defects only
+  void countProfile(Rectangle row, int start, std::vector<RowProfileStep> &profile);
+  // Same as count, with the range of widths giving the same result; rows without defects only
+  RowWidthRange countWidthRange(Rectangle row, int start);
+  bool countIsApproximate() const;
 
  private:
   RowDescription countNoDefectsSimple();
@@ -46,6 +70,7 @@ class RowPacker : Packer {
 
   void fillXData(RowDescription &description, int maxUsedX) const;
   void fillYData(RowDescription &description) const;
+  void fillYData(RowDescription &description, int maxHeight, bool tightY) const;
   bool fitsDimensionsAt(int minX, int width, int height) const;
   int earliestFit(int minX, int width, int height) const;
   bool canPlace(int x, int width, int height);
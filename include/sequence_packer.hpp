@@ -7,29 +7,42 @@
 #include "solution.hpp"
 #include "solver_params.hpp"
 
+#include <future>
+
 class SequencePacker {
  public:
   static Solution run(const Problem &problem, const std::vector<Item> &sequence, SolverParams options, const Solution &existing=Solution());
+  // Same, when the range of the sequence that differs from the existing solution is already known
+  static Solution run(const Problem &problem, const std::vector<Item> &sequence, SolverParams options, const Solution &existing, int beginDiff, int endDiff);
 
  private:
-  SequencePacker(const Problem &problem, const std::vector<Item> &sequence, SolverParams options, const Solution &existing);
+  SequencePacker(const Problem &problem, const std::vector<Item> &sequence, SolverParams options, const Solution &existing, int beginDiff, int endDiff);
+  static void diffBounds(const std::vector<Item> &sequence, const Solution &existing, int &beginDiff, int &endDiff);
   void run();
   void runNoCancel();
   void runEarlyCancel();
+  PlateSolution packPlate();
+  std::vector<int> guessPlateEnds() const;
 
   int nItems() const { return sequence_.size(); }
-  int sequenceBeginDiff() const;
-  int sequenceEndDiff() const;
+  bool cancelled() const;
 
  private:
   const Problem &problem_;
   const Solution &existingSolution_;
   const std::vector<Item> &sequence_;
   SolverParams options_;
+  int beginDiff_;
+  int endDiff_;
 
   Solution solution_;
   int packedItems_;
   int packedExistingItems_;
+
+  // Packing of the next plate from the start that was guessed, by a speculative thread; destroyed first since it uses the packer
+  std::future<PlateSolution> guessed_;
+  int guessedPlate_;
+  int guessedStart_;
 };
 
 #endif
@@ -6,6 +6,7 @@
 #include "item.hpp"
 #include "node.hpp"
 #include "rectangle.hpp"
+#include "cow.hpp"
 
 #include <vector>
 #include <iosfwd>
@@ -74,7 +75,8 @@ struct PlateSolution : Rectangle {
 };
 
 struct Solution {
-  std::vector<PlateSolution> plates;
+  // Shared between copies of the solution; copied only when modified
+  std::vector<Cow<PlateSolution> > plates;
 
   int nItems() const;
   int nPlates() const { return plates.size(); }
@@ -83,6 +85,7 @@ struct Solution {
   std::vector<int> sequence() const;
   std::vector<Item> sequence(const Problem&) const;
   void write(std::string fileName) const;
+  void write(std::ostream &s) const;
 
   static std::vector<int> readOrdering(std::string filename);
 };
@@ -0,0 +1,73 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#ifndef SOLUTION_VIEW_HPP
+#define SOLUTION_VIEW_HPP
+
+#include "problem.hpp"
+#include "solution.hpp"
+
+#include <vector>
+#include <cstdint>
+
+/*
+ * Flat view of a solution, as used by the moves
+ *
+ * The items are stored by id in sequence order, and the rows, cuts and plates are
+ * given by their offsets in this sequence, with one more offset than elements.
+ * The view points to the solution it was built from and must be rebuilt when it
+ * changes; it is never modified afterwards, so it can be shared by the threads.
+ */
+class SolutionView {
+ public:
+  SolutionView();
+  SolutionView(const Problem &problem, const Solution &solution);
+
+  const std::vector<int> &sequence() const { return sequence_; }
+  // Equivalence class of the item at each position of the sequence
+  const std::vector<int> &classes() const { return classes_; }
+  // Whether the sequence has every item once, in the order of their stacks
+  bool valid() const { return valid_; }
+  // Sum of the hashes of the items, that only depend on their dimensions: sequences with the same hash give the same packing
+  std::uint64_t hash() const { return hash_; }
+  static std::uint64_t itemHash(int position, const Item &item);
+
+  const std::vector<int> &itemOffsets() const { return itemOffsets_; }
+  const std::vector<int> &rowOffsets() const { return rowOffsets_; }
+  const std::vector<int> &cutOffsets() const { return cutOffsets_; }
+  const std::vector<int> &plateOffsets() const { return plateOffsets_; }
+
+  int nRows() const { return rows_.size(); }
+  int nCuts() const { return cuts_.size(); }
+  int nPlates() const { return plates_.size(); }
+
+  const RowSolution &row(int row) const { return *rows_[row]; }
+  const CutSolution &cut(int cut) const { return *cuts_[cut]; }
+  const PlateSolution &plate(int plate) const { return *plates_[plate]; }
+
+  int plateOfRow(int row) const { return rowPlates_[row]; }
+  int plateOfCut(int cut) const { return cutPlates_[cut]; }
+
+ private:
+  std::vector<int> sequence_;
+  std::vector<int> classes_;
+  bool valid_;
+  std::uint64_t hash_;
+
+  std::vector<int> itemOffsets_;
+  std::vector<int> rowOffsets_;
+  std::vector<int> cutOffsets_;
+  std::vector<int> plateOffsets_;
+
+  std::vector<const RowSolution*> rows_;
+  std::vector<const CutSolution*> cuts_;
+  std::vector<const PlateSolution*> plates_;
+
+  std::vector<int> rowPlates_;
+  std::vector<int> cutPlates_;
+
+ private:
+  bool checkValid(const Problem &problem) const;
+};
+
+#endif
+
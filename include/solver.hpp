@@ -5,14 +5,30 @@
 
 #include "problem.hpp"
 #include "solution.hpp"
+#include "solution_view.hpp"
 #include "solver_params.hpp"
+#include "cancellation.hpp"
+#include "move_log.hpp"
+#include "profile.hpp"
 
 #include <memory>
 #include <random>
 #include <chrono>
+#include <functional>
 
 class Move;
 
+struct SolverCallbacks {
+  // Called with the new best solution whenever the solver improves it
+  std::function<void(const Solution&)> onImprovement;
+  // When cancelled, the solver returns its best solution within a few milliseconds
+  const CancellationToken *cancellation;
+
+  SolverCallbacks()
+  : cancellation(nullptr) {
+  }
+};
+
 class Solver {
  public:
   enum class MoveStatus {
@@ -22,18 +38,29 @@ class Solver {
     Plateau,
     Improvement
   };
-  static Solution run(const Problem &problem, SolverParams params, const Solution &initial=Solution());
+  static Solution run(const Problem &problem, SolverParams params, const Solution &initial=Solution(), SolverCallbacks callbacks=SolverCallbacks());
+  // Run again, on a single thread, the moves [firstMove, lastMove) of a recorded run with the same problem, options and initial solution
+  static Solution replay(const Problem &problem, SolverParams params, const Solution &initial, const std::string &logFile, std::size_t firstMove, std::size_t lastMove);
  
  private: 
-  Solver(const Problem &problem, SolverParams params, const Solution &initial);
+  Solver(const Problem &problem, SolverParams params, const Solution &initial, SolverCallbacks callbacks);
   void init(const Solution &initial);
   void run();
-  Move* pickMove();
-  Move* pickMove(const std::vector<std::pair<std::unique_ptr<Move>, int> > &moves);
+  void replay(const MoveLog &log, std::size_t firstMove, std::size_t lastMove);
+  Move* pickMove(std::size_t moveIndex, std::mt19937 &rgen);
+  Move* pickMove(const std::vector<std::pair<std::unique_ptr<Move>, int> > &moves, std::mt19937 &rgen);
+  std::mt19937 moveGenerator(std::size_t moveIndex) const;
+  std::size_t spareThreads(std::size_t parallelEvals) const;
 
+  void setSolution(const Solution &solution);
+  bool knownSequence(std::uint64_t hash) const;
+  bool boundReached() const;
   void step();
+  void stepDeterministic();
   MoveStatus accept(Move &move, const Solution &incumbent);
   void updateStats(Move &move, MoveStatus status, const Solution &incumbent);
+  void recordMove(std::size_t moveIndex, const Move &move, MoveStatus status, bool skipped);
+  Move* recordedMove(int id) const;
   void finalReport() const;
 
   void addInitializer(std::unique_ptr<Move> &&move, int weight=100);
@@ -42,17 +69,27 @@ class Solver {
  private:
   const Problem &problem_;
   SolverParams params_;
+  SolverCallbacks callbacks_;
   std::vector<std::pair<std::unique_ptr<Move>, int> > moves_;
   std::vector<std::pair<std::unique_ptr<Move>, int> > initializers_;
 
   Solution solution_;
+  // Rebuilt with each new solution, for the moves
+  SolutionView view_;
+  // Hashes of the sequences evaluated recently, indexed by their low bits; only modified between evaluations
+  std::vector<std::uint64_t> recentSequences_;
   double bestMapped_;
   double bestDensity_;
+  double densityBound_;
 
   std::vector<std::mt19937> rgens_;
   std::size_t nMoves_;
-  std::chrono::time_point<std::chrono::system_clock> startTime_;
-  std::chrono::time_point<std::chrono::system_clock> endTime_;
+  std::uint32_t nBatches_;
+  MoveLog moveLog_;
+  Profile profile_;
+  Deadline deadline_;
+  std::chrono::time_point<std::chrono::steady_clock> startTime_;
+  std::chrono::time_point<std::chrono::steady_clock> endTime_;
 
   friend class Move;
 };
@@ -4,6 +4,10 @@
 #define SOLVER_PARAMS_HPP
 
 #include <cstddef>
+#include <limits>
+#include <string>
+
+class Deadline;
 
 enum class PackingOption {
   Approximate,
@@ -20,26 +24,54 @@ struct SolverParams {
   double timeLimit;
   bool failOnViolation;
   bool earlyCancel;
+  // Skip the moves whose sequence has the same dimensions as the incumbent's or as a recently evaluated one
+  bool skipKnownSequences;
+  // Stop as soon as the incumbent reaches the lower bound on the used area
+  bool stopAtBound;
+  // Seed each move by its index and evaluate it from the solution a sequential run would have: same result for any number of threads
+  bool deterministic;
+  // Binary log of the moves, written at the end of the run to replay them; none if empty
+  std::string moveLogFile;
+  // Anytime profile of the improvements, written at the end of the run (CSV, or JSON if it ends with .json); none if empty
+  std::string profileFile;
 
   PackingOption rowPacking;
   PackingOption cutPacking;
   PackingOption platePacking;
   bool tracePackingFronts;
+  // Share the counts of cuts without defects between plates and threads
+  bool cacheCuts;
+  // Threads packing the next plate ahead of time in full packings; 0 packs the plates one after the other
+  std::size_t speculativeThreads;
+  // Plates per window in the decomposition solver
+  std::size_t windowPlates;
+
+  // Checked by the packing algorithms, which stop early once it has expired; a solver run given one stops by it too
+  const Deadline *deadline;
 
+  // Same defaults as the command line
   SolverParams() {
     verbosity = 0;
     seed = 0;
-    nbThreads = 0;
-    initializationRuns = 0;
-    moveLimit = 0;
-    timeLimit = 0.0;
+    nbThreads = 1;
+    initializationRuns = 1000;
+    moveLimit = std::numeric_limits<std::size_t>::max();
+    timeLimit = 3.0;
     failOnViolation = false;
-    earlyCancel = false;
+    earlyCancel = true;
+    skipKnownSequences = true;
+    stopAtBound = true;
+    deterministic = false;
 
     rowPacking = PackingOption::Approximate;
     cutPacking = PackingOption::Approximate;
     platePacking = PackingOption::Approximate;
     tracePackingFronts = false;
+    cacheCuts = true;
+    speculativeThreads = 0;
+    windowPlates = 8;
+
+    deadline = nullptr;
   }
 };
 
@@ -0,0 +1,57 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#ifndef TRACER_HPP
+#define TRACER_HPP
+
+#include <atomic>
+#include <string>
+#include <cstdint>
+
+/*
+ * Timeline of the solver, written as a Chrome trace (chrome://tracing or Perfetto)
+ *
+ * Each thread records its spans in its own ring buffer, so that recording never
+ * locks; the oldest spans are overwritten once a buffer is full. The buffers are
+ * reused by the threads created later, and each one is a line of the timeline.
+ * When tracing is disabled, a span only checks a flag.
+ */
+class Tracer {
+ public:
+  // Number of spans kept per thread
+  static void enable(std::size_t capacity = 1 << 15);
+  static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+  // Only once the traced threads are done
+  static void write(const std::string &fileName);
+  // Copy of the name that lives as long as the process, for the names built at runtime
+  static const char *intern(const std::string &name);
+
+  class Span {
+   public:
+    // Names are not copied: they must outlive the tracing
+    Span(const char *name, const char *category = "solver")
+    : name_(name)
+    , category_(category)
+    , begin_(enabled() ? now() : -1) {
+    }
+    ~Span() {
+      if (begin_ >= 0) record(name_, category_, begin_, now());
+    }
+    Span(const Span&) = delete;
+    Span &operator=(const Span&) = delete;
+
+   private:
+    const char *name_;
+    const char *category_;
+    std::int64_t begin_;
+  };
+
+ private:
+  static std::int64_t now();
+  static void record(const char *name, const char *category, std::int64_t begin, std::int64_t end);
+
+ private:
+  static std::atomic<bool> enabled_;
+};
+
+#endif
+
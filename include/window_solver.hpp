@@ -0,0 +1,62 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#ifndef WINDOW_SOLVER_HPP
+#define WINDOW_SOLVER_HPP
+
+#include "problem.hpp"
+#include "solution.hpp"
+#include "solver.hpp"
+#include "solver_params.hpp"
+#include "profile.hpp"
+
+#include <vector>
+#include <chrono>
+
+/*
+ * Decomposition of the incumbent into windows of consecutive plates.
+ *
+ * The items of a window form an independent sub-problem: as long as the
+ * windows are put back in the same order, the stack order is preserved
+ * whatever the order within each window. The windows are solved concurrently,
+ * each starting from its part of the incumbent, then their sequences are
+ * stitched together and packed again on the whole problem. The stitched
+ * solution is kept unless it is worse than the incumbent. Window boundaries
+ * are shifted from one round to the next so that items can cross them.
+ */
+class WindowSolver {
+ public:
+  struct Window {
+    Problem problem;
+    Solution solution;
+    // Id in the original problem of each item of the sub-problem
+    std::vector<int> itemIds;
+  };
+
+  static Solution run(const Problem &problem, SolverParams params, const Solution &initial=Solution(), SolverCallbacks callbacks=SolverCallbacks());
+
+  // Sub-problem with the items of plates [firstPlate, lastPlate), and the defects of the plates from firstPlate on
+  static Window extract(const Problem &problem, const Solution &solution, int firstPlate, int lastPlate);
+
+ private:
+  WindowSolver(const Problem &problem, SolverParams params, SolverCallbacks callbacks);
+  void run(const Solution &initial);
+  void runRound(int round, double slice);
+  std::vector<int> windowBoundaries(int round) const;
+  bool accept(const Solution &solution);
+  double remainingTime() const;
+
+ private:
+  const Problem &problem_;
+  SolverParams params_;
+  SolverCallbacks callbacks_;
+
+  Solution solution_;
+  double mapped_;
+  double density_;
+  double densityBound_;
+  std::chrono::time_point<std::chrono::steady_clock> startTime_;
+  Profile profile_;
+};
+
+#endif
+
@@ -0,0 +1,229 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#include "batch_solver.hpp"
+#include "solver.hpp"
+#include "solution_checker.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <algorithm>
+#include <set>
+
+using namespace std;
+
+namespace {
+// Shortest run given to an instance; the first run of an instance always goes on until it has a solution
+constexpr double minSlice = 0.01;
+}
+
+vector<BatchInstance> BatchSolver::readManifest(string manifest) {
+  ifstream f(manifest.c_str());
+  if (f.fail())
+    throw runtime_error("Couldn't open file \"" + manifest + "\".");
+
+  vector<BatchInstance> instances;
+  string line;
+  while (getline(f, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    stringstream ss(line);
+    string token;
+    vector<string> fields;
+    while (getline(ss, token, ';')) {
+      fields.push_back(token);
+    }
+
+    BatchInstance instance;
+    if (fields.size() == 1) {
+      // The solution goes to the current directory: next to the instance, it would replace the reference solution of the dataset
+      size_t slash = fields[0].find_last_of("/\\");
+      string baseName = slash == string::npos ? fields[0] : fields[0].substr(slash + 1);
+      instance.name = fields[0];
+      instance.batchFile = fields[0] + "_batch.csv";
+      instance.defectFile = fields[0] + "_defects.csv";
+      instance.solutionFile = baseName + "_solution.csv";
+    }
+    else if (fields.size() == 3) {
+      instance.name = fields[0];
+      instance.batchFile = fields[0];
+      instance.defectFile = fields[1];
+      instance.solutionFile = fields[2];
+    }
+    else {
+      throw runtime_error("A manifest line must be either an instance name or batch;defects;solution files but the following line was received: \"" + line + "\".");
+    }
+    instances.push_back(instance);
+  }
+
+  set<string> solutionFiles;
+  for (const BatchInstance &instance : instances) {
+    if (!solutionFiles.insert(instance.solutionFile).second)
+      throw runtime_error("Several instances of the manifest write to the solution file \"" + instance.solutionFile + "\".");
+  }
+  return instances;
+}
+
+void BatchSolver::run(const vector<BatchInstance> &instances, SolverParams params, bool permissive) {
+  BatchSolver solver(instances, params, permissive);
+  solver.run();
+}
+
+BatchSolver::BatchSolver(const vector<BatchInstance> &instances, SolverParams params, bool permissive)
+: instances_(instances)
+, params_(params) {
+  if (instances_.empty()) throw runtime_error("No instance provided in the manifest.");
+  for (const BatchInstance &instance : instances_) {
+    states_.emplace_back(Problem::read(instance.batchFile, instance.defectFile, permissive));
+  }
+  // One worker per instance at most; when there are fewer instances than threads, the runs share all of them
+  nWorkers_ = max((size_t) 1, min(params_.nbThreads, states_.size()));
+}
+
+void BatchSolver::run() {
+  startTime_ = chrono::steady_clock::now();
+
+  vector<thread> workers;
+  for (size_t i = 0; i < nWorkers_; ++i) {
+    size_t nThreads = max((size_t) 1, params_.nbThreads / nWorkers_ + (i < params_.nbThreads % nWorkers_ ? 1 : 0));
+    workers.push_back(thread(&BatchSolver::runWorker, this, nThreads));
+  }
+  for (thread &worker : workers) {
+    worker.join();
+  }
+
+  for (size_t i = 0; i < states_.size(); ++i) {
+    if (!instances_[i].solutionFile.empty())
+      states_[i].solution.write(instances_[i].solutionFile);
+  }
+  finalReport();
+}
+
+void BatchSolver::runWorker(size_t nThreads) {
+  while (true) {
+    int ind;
+    Deadline deadline;
+    {
+      unique_lock<mutex> lock(mutex_);
+      // Wait for a busy instance rather than leave its threads idle; done once no instance is busy
+      while ((ind = pickInstance()) < 0) {
+        bool busy = any_of(states_.begin(), states_.end(), [](const InstanceState &state) { return state.busy; });
+        if (!busy) return;
+        released_.wait(lock);
+      }
+      // The slice already accounts for the remaining budget
+      auto slice = chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(sliceLength()));
+      deadline = Deadline(chrono::steady_clock::now() + slice);
+      states_[ind].busy = true;
+    }
+    solveInstance(ind, deadline, nThreads);
+  }
+}
+
+int BatchSolver::pickInstance() const {
+  // Every instance is run at least once, even if the time budget is exceeded
+  for (int i = 0; i < (int) states_.size(); ++i) {
+    if (!states_[i].busy && states_[i].nRuns == 0)
+      return i;
+  }
+  if (remainingTime() <= minSlice)
+    return -1;
+
+  // Then favour the instances that improved recently, relative to the time already spent on them; those already optimal are done
+  int best = -1;
+  double bestScore = 0.0;
+  for (int i = 0; i < (int) states_.size(); ++i) {
+    const InstanceState &state = states_[i];
+    if (state.busy) continue;
+    if (params_.stopAtBound && state.boundReached()) continue;
+    double score = state.timeSpent * (1 + state.nStalled);
+    if (best < 0 || score < bestScore) {
+      best = i;
+      bestScore = score;
+    }
+  }
+  return best;
+}
+
+double BatchSolver::sliceLength() const {
+  // Short enough for every instance to be visited several times within the budget
+  double slice = params_.timeLimit * nWorkers_ / (4.0 * states_.size());
+  slice = min(slice, params_.timeLimit / 4.0);
+  slice = min(slice, remainingTime());
+  return max(slice, minSlice);
+}
+
+double BatchSolver::remainingTime() const {
+  double elapsed = chrono::duration<double>(chrono::steady_clock::now() - startTime_).count();
+  return params_.timeLimit - elapsed;
+}
+
+void BatchSolver::solveInstance(int ind, const Deadline &deadline, size_t nThreads) {
+  SolverParams params = params_;
+  Solution initial;
+  {
+    lock_guard<mutex> lock(mutex_);
+    const InstanceState &state = states_[ind];
+    initial = state.solution;
+    params.seed = params_.seed + state.nRuns;
+    if (state.nRuns > 0)
+      params.initializationRuns = 0;
+  }
+  params.nbThreads = nThreads;
+  // The deadline ends the run; the time limit of the whole batch is only an upper bound
+  params.deadline = &deadline;
+  params.verbosity = max(0, params_.verbosity - 2);
+  params.moveLogFile.clear();
+  params.profileFile.clear();
+
+  const Problem &problem = states_[ind].problem;
+  auto runStart = chrono::steady_clock::now();
+  Solution solution = Solver::run(problem, params, initial);
+  double runTime = chrono::duration<double>(chrono::steady_clock::now() - runStart).count();
+
+  double mapped = SolutionChecker::evalPercentMapped(problem, solution);
+  double density = SolutionChecker::evalPercentDensity(problem, solution);
+
+  lock_guard<mutex> lock(mutex_);
+  InstanceState &state = states_[ind];
+  bool valid = solution.nItems() != 0;
+  bool first = state.solution.nItems() == 0;
+  bool improved = valid && (first || mapped > state.mapped || (mapped == state.mapped && density > state.density));
+  if (improved) {
+    state.nStalled = 0;
+  }
+  else {
+    ++state.nStalled;
+  }
+  // An empty solution never replaces the stored one, even on the first run
+  if (valid && (first || mapped > state.mapped || (mapped == state.mapped && density >= state.density))) {
+    state.solution = solution;
+    state.mapped = mapped;
+    state.density = density;
+  }
+  state.timeSpent += runTime;
+  ++state.nRuns;
+  state.busy = false;
+  released_.notify_all();
+
+  if (params_.verbosity >= 2) {
+    cout << instances_[ind].name << "\t" << state.density << "%\t" << state.nRuns << "\t" << (improved ? "Improved" : "Stalled") << endl;
+  }
+}
+
+void BatchSolver::finalReport() const {
+  if (params_.verbosity < 1) return;
+  cout << endl << "Instance\tDensity\tMapped\tRuns\tTime" << endl;
+  for (size_t i = 0; i < states_.size(); ++i) {
+    const InstanceState &state = states_[i];
+    cout << instances_[i].name;
+    cout << "\t" << state.density << "%";
+    cout << "\t" << state.mapped << "%";
+    cout << "\t" << state.nRuns;
+    cout << "\t" << state.timeSpent << "s";
+    cout << endl;
+  }
+  cout << endl;
+  cout << states_.size() << " instances solved in ";
+  cout << chrono::duration<double>(chrono::steady_clock::now() - startTime_).count() << "s" << endl;
+}
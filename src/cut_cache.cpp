@@ -0,0 +1,117 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#include "cut_cache.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+// Number of items used to find the slot of a cut, so that cuts with different items spread over the table
+const int nIndexItems = 4;
+
+uint64_t mix(uint64_t h, uint64_t v) {
+  h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+  h ^= h >> 31;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  return h ^ (h >> 29);
+}
+
+uint64_t itemDimensions(const Item &item) {
+  return ((uint64_t) item.width << 16) | (uint64_t) item.height;
+}
+}
+
+CutCache &CutCache::global() {
+  static CutCache cache(18);
+  return cache;
+}
+
+CutCache::CutCache(int logSize)
+: mask_(((size_t) 1 << logSize) - 1)
+, slots_(new Slot[(size_t) 1 << logSize]) {
+  clear();
+}
+
+void CutCache::clear() {
+  for (size_t i = 0; i <= mask_; ++i) {
+    slots_[i].version.store(0, memory_order_relaxed);
+    slots_[i].key.store(0, memory_order_relaxed);
+    slots_[i].data.store(0, memory_order_relaxed);
+  }
+}
+
+bool CutCache::lookup(const vector<Item> &sequence, int start, int width, Entry &entry) const {
+  const Slot &slot = slots_[slotIndex(sequence, start, width)];
+  uint32_t version = slot.version.load(memory_order_acquire);
+  if (version & 1) return false;
+  uint64_t key = slot.key.load(memory_order_relaxed);
+  uint64_t data = slot.data.load(memory_order_relaxed);
+  atomic_thread_fence(memory_order_acquire);
+  if (slot.version.load(memory_order_relaxed) != version) return false;
+
+  entry = unpack(data);
+  if (entry.nExamined == 0 || start + entry.nExamined > (int) sequence.size())
+    return false;
+  return key == windowKey(sequence, start, entry.nExamined, width);
+}
+
+void CutCache::insert(const vector<Item> &sequence, int start, int width, const Entry &entry) {
+  // Entries that do not fit in the packed representation are not cached
+  if (entry.nExamined <= 0 || entry.nExamined >= (1 << 12)
+   || entry.maxUsedX < 0 || entry.maxUsedX >= (1 << 13)
+   || entry.minWidth < 0 || entry.maxWidth >= (1 << 13))
+    return;
+  Slot &slot = slots_[slotIndex(sequence, start, width)];
+  uint32_t version = slot.version.load(memory_order_relaxed);
+  if ((version & 1) || !slot.version.compare_exchange_strong(version, version + 1, memory_order_acquire))
+    return;
+  atomic_thread_fence(memory_order_release);
+  slot.key.store(windowKey(sequence, start, entry.nExamined, width), memory_order_relaxed);
+  slot.data.store(pack(entry), memory_order_relaxed);
+  slot.version.store(version + 2, memory_order_release);
+}
+
+size_t CutCache::slotIndex(const vector<Item> &sequence, int start, int width) const {
+  uint64_t h = mix(0, width);
+  int end = min((int) sequence.size(), start + nIndexItems);
+  for (int i = start; i < end; ++i) {
+    h = mix(h, itemDimensions(sequence[i]));
+  }
+  return h & mask_;
+}
+
+uint64_t CutCache::windowKey(const vector<Item> &sequence, int start, int nExamined, int width) {
+  uint64_t h = mix(mix(1, width), nExamined);
+  for (int i = start; i < start + nExamined; ++i) {
+    h = mix(h, itemDimensions(sequence[i]));
+  }
+  return h;
+}
+
+uint64_t CutCache::pack(const Entry &entry) {
+  uint64_t data = entry.nItems;
+  data = (data << 13) | entry.maxUsedX;
+  data = (data << 1) | (entry.tightX ? 1 : 0);
+  data = (data << 12) | entry.nExamined;
+  data = (data << 13) | entry.minWidth;
+  data = (data << 13) | entry.maxWidth;
+  return data;
+}
+
+CutCache::Entry CutCache::unpack(uint64_t data) {
+  Entry entry;
+  entry.maxWidth = data & ((1 << 13) - 1);
+  data >>= 13;
+  entry.minWidth = data & ((1 << 13) - 1);
+  data >>= 13;
+  entry.nExamined = data & ((1 << 12) - 1);
+  data >>= 12;
+  entry.tightX = data & 1;
+  data >>= 1;
+  entry.maxUsedX = data & ((1 << 13) - 1);
+  data >>= 13;
+  entry.nItems = data & ((1 << 12) - 1);
+  return entry;
+}
+
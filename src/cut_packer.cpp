@@ -1,7 +1,9 @@
 // Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
 
 #include "cut_packer.hpp"
+#include "cut_cache.hpp"
 #include "utils.hpp"
+#include "perf_counters.hpp"
 
 #include <cassert>
 #include <algorithm>
@@ -11,7 +13,10 @@ using namespace std;
 
 CutPacker::CutPacker(const vector<Item> &sequence, SolverParams options)
 : Packer(sequence, options)
-, rowPacker_(sequence, options) {
+, rowPacker_(sequence, options)
+, minWidth_(0)
+, maxWidth_(0)
+, maxExamined_(0) {
 }
 
 CutSolution CutPacker::run(Rectangle cut, int start, const vector<Defect> &defects) {
@@ -28,8 +33,11 @@ CutSolution CutPacker::run(Rectangle cut, int start, const vector<Defect> &defec
 }
 
 CutPacker::CutDescription CutPacker::count(Rectangle cut, int start, const vector<Defect> &defects) {
+  PerfCounters::Scope scope(PerfCounters::CutCount);
   setup(cut, start, defects);
   if (options_.cutPacking == PackingOption::Approximate) {
+    if (options_.cacheCuts && nDefects() == 0)
+      return countCached();
     return countApproximate();
   }
   else if (options_.cutPacking == PackingOption::Exact) {
@@ -40,6 +48,28 @@ CutPacker::CutDescription CutPacker::count(Rectangle cut, int start, const vecto
   }
 }
 
+CutPacker::CutWidthRange CutPacker::countWidthRange(Rectangle cut, int start, const vector<Defect> &defects) {
+  CutWidthRange range;
+  range.description = count(cut, start, defects);
+  range.minMaxX = region_.minX() + minWidth_;
+  range.maxMaxX = region_.minX() + maxWidth_;
+  // The last cut is moved to the end of the region in some cases
+  if (options_.cutPacking != PackingOption::Approximate || range.description.maxUsedX >= region_.maxX()) {
+    range.minMaxX = region_.maxX();
+    range.maxMaxX = region_.maxX();
+  }
+  // The defects in the cut must stay the same
+  for (const Defect &defect : defects) {
+    if (defect.maxX() < region_.minX())
+      continue;
+    if (defect.minX() <= region_.maxX())
+      range.minMaxX = max(range.minMaxX, defect.minX());
+    else
+      range.maxMaxX = min(range.maxMaxX, defect.minX() - 1);
+  }
+  return range;
+}
+
 CutSolution CutPacker::runApproximate() {
   commonApproximate();
   return backtrack();
@@ -75,6 +105,32 @@ CutPacker::CutDescription CutPacker::countApproximate() {
   return countBacktrack();
 }
 
+CutPacker::CutDescription CutPacker::countCached() {
+  // Without defects, the count only depends on the width and on the items examined
+  CutCache::Entry entry;
+  if (CutCache::global().lookup(sequence_, start_, region_.width(), entry)) {
+    minWidth_ = entry.minWidth;
+    maxWidth_ = entry.maxWidth;
+    CutDescription description;
+    description.nItems = entry.nItems;
+    description.maxUsedX = region_.minX() + entry.maxUsedX;
+    description.tightX = entry.tightX;
+    return description;
+  }
+  CutDescription description = countApproximate();
+  // Not cached when the result depends on the end of the sequence
+  if (maxExamined_ <= nItems()) {
+    entry.nExamined = maxExamined_ - start_;
+    entry.nItems = description.nItems;
+    entry.maxUsedX = description.maxUsedX - region_.minX();
+    entry.tightX = description.tightX;
+    entry.minWidth = minWidth_;
+    entry.maxWidth = maxWidth_;
+    CutCache::global().insert(sequence_, start_, region_.width(), entry);
+  }
+  return description;
+}
+
 CutPacker::CutDescription CutPacker::countExact() {
   commonExact();
   return countBacktrack();
@@ -92,6 +148,9 @@ CutPacker::CutDescription CutPacker::countDiagnostic() {
 void CutPacker::setup(Rectangle cut, int start, const vector<Defect> &defects) {
   init(cut, start, defects);
   checkConsistency();
+  minWidth_ = Params::minXX;
+  maxWidth_ = Params::widthPlates;
+  maxExamined_ = start;
   sort(defects_.begin(), defects_.end(),
         [](const Defect &a, const Defect &b) {
           return a.maxY() < b.maxY();
@@ -101,13 +160,11 @@ void CutPacker::setup(Rectangle cut, int start, const vector<Defect> &defects) {
 }
 
 void CutPacker::commonApproximate() {
-  // Fill the front
-  front_.clear();
-  front_.init(region_.minY(), start_);
-  for (int i = 0; i < front_.size(); ++i) {
-    propagate(i, front_[i].end);
-    propagateBreakpoints(i);
-  }
+  // Dispatch once per cut, so that the propagation without defects skips all defect checks
+  if (nDefects() == 0)
+    fillFront<false>();
+  else
+    fillFront<true>();
   front_.checkConsistency();
 
   // Build the slices
@@ -129,10 +186,24 @@ void CutPacker::commonApproximate() {
   reverse(slices_.begin(), slices_.end());
 }
 
+template<bool HasDefects>
+void CutPacker::fillFront() {
+  front_.clear();
+  front_.init(region_.minY(), start_);
+  for (int i = 0; i < front_.size(); ++i) {
+    propagate<HasDefects>(i, front_[i].end);
+    if (HasDefects)
+      propagateBreakpoints(i);
+  }
+}
+
 void CutPacker::commonExact() {
   // Fill the front
   vector<int> front(Params::heightPlates + 1, -1);
   vector<int> prev(Params::heightPlates + 1, -1);
+  // The rows from a given coordinate are counted for every height, so they are profiled once
+  vector<vector<RowPacker::RowProfileStep> > profiles(Params::heightPlates + 1);
+  vector<int> profileMaxY(Params::heightPlates + 1, -1);
   front[0] = start_;
   for (int j = Params::minYY; j <= Params::heightPlates; ++j) {
     int best = -1;
@@ -141,7 +212,9 @@ void CutPacker::commonExact() {
     if (j != Params::heightPlates && j > Params::heightPlates - Params::minYY) continue;
     for (int i = 0; i <= j - Params::minYY; ++i) {
       if (front[i] < 0) continue;
-      int cnt = front[i] + countRow(front[i], i, j).nItems;
+      if (profileMaxY[i] < 0)
+        profileMaxY[i] = computeRowProfile(front[i], i, profiles[i]);
+      int cnt = front[i] + countRowFromProfile(profiles[i], profileMaxY[i], front[i], i, j).nItems;
       if (cnt > best) {
         best = cnt;
         pred = i;
@@ -164,9 +237,61 @@ void CutPacker::commonExact() {
   reverse(slices_.begin(), slices_.end());
 }
 
+template<bool HasDefects>
 RowPacker::RowDescription CutPacker::countRow(int start, int minY, int maxY) {
   Rectangle row = Rectangle::FromCoordinates(region_.minX(), minY, region_.maxX(), maxY);
-  return rowPacker_.count(row, start, defects_);
+  int width = region_.width();
+  if (!rowPacker_.countIsApproximate() || (HasDefects && rowHasDefects(minY, maxY))) {
+    minWidth_ = width;
+    maxWidth_ = width;
+    maxExamined_ = nItems() + 1;
+    return rowPacker_.count(row, start, defects_);
+  }
+  // Rows without defects give the same result for a range of widths
+  RowPacker::RowWidthRange range = rowPacker_.countWidthRange(row, start);
+  minWidth_ = max(minWidth_, range.minWidth);
+  maxWidth_ = min(maxWidth_, range.maxWidth);
+  // The greedy packing stops at the first item that does not fit
+  maxExamined_ = max(maxExamined_, start + range.description.nItems + 1);
+  RowPacker::RowDescription description = range.description;
+  description.maxUsedX += region_.minX();
+  return description;
+}
+
+bool CutPacker::rowHasDefects(int minY, int maxY) const {
+  for (const Defect &defect : defects_) {
+    if (defect.minY() <= maxY && defect.maxY() >= minY)
+      return true;
+  }
+  return false;
+}
+
+int CutPacker::computeRowProfile(int start, int minY, vector<RowPacker::RowProfileStep> &profile) {
+  // Profile the rows starting at minY, up to the first defect
+  profile.clear();
+  if (!rowPacker_.countIsApproximate())
+    return minY;
+  int maxY = region_.maxY();
+  for (const Defect &defect : defects_) {
+    if (defect.maxY() >= minY)
+      maxY = min(maxY, defect.minY() - 1);
+  }
+  if (maxY < minY + Params::minYY)
+    return minY;
+  Rectangle row = Rectangle::FromCoordinates(region_.minX(), minY, region_.maxX(), maxY);
+  rowPacker_.countProfile(row, start, profile);
+  return maxY;
+}
+
+RowPacker::RowDescription CutPacker::countRowFromProfile(const vector<RowPacker::RowProfileStep> &profile, int profileMaxY, int start, int minY, int maxY) {
+  if (maxY > profileMaxY)
+    return countRow(start, minY, maxY);
+  auto it = lower_bound(profile.begin(), profile.end(), maxY,
+      [](const RowPacker::RowProfileStep &step, int y) {
+        return step.maxMaxY < y;
+      });
+  assert (it != profile.end() && it->minMaxY < maxY);
+  return it->description;
 }
 
 RowSolution CutPacker::packRow(int start, int minY, int maxY) {
@@ -174,19 +299,20 @@ RowSolution CutPacker::packRow(int start, int minY, int maxY) {
   return rowPacker_.run(row, start, defects_);
 }
 
+template<bool HasDefects>
 void CutPacker::propagate(int previousFront, int beginCoord) {
   int previousItems = front_[previousFront].value;
   for (int endCoord = region_.maxY() + Params::minWaste; endCoord >= beginCoord + Params::minYY; --endCoord) {
-    if (!isAdmissibleCutLine(endCoord)) continue;
-    RowPacker::RowDescription result = countRow(previousItems, beginCoord, endCoord);
+    if (!isAdmissibleCutLine<HasDefects>(endCoord)) continue;
+    RowPacker::RowDescription result = countRow<HasDefects>(previousItems, beginCoord, endCoord);
     if (utils::fitsMinWaste(result.maxUsedY, result.tightY, region_.maxY())) {
       int coord = utils::extendToFit(result.maxUsedY, region_.maxY(), Params::minYY);
       front_.insert(beginCoord, coord, previousItems + result.nItems, previousFront);
     }
     if (!result.tightY
-     && isAdmissibleCutLine(result.maxUsedY - Params::minWaste)
+     && isAdmissibleCutLine<HasDefects>(result.maxUsedY - Params::minWaste)
      && result.maxUsedY - Params::minWaste >= beginCoord + Params::minYY) {
-      RowPacker::RowDescription tight = countRow(previousItems, beginCoord, result.maxUsedY - Params::minWaste);
+      RowPacker::RowDescription tight = countRow<HasDefects>(previousItems, beginCoord, result.maxUsedY - Params::minWaste);
       if (utils::fitsMinWaste(tight.maxUsedY, tight.tightY, region_.maxY())) {
         int coord = utils::extendToFit(tight.maxUsedY, region_.maxY(), Params::minYY);
         front_.insert(beginCoord, coord, previousItems + tight.nItems, previousFront);
@@ -218,11 +344,11 @@ void CutPacker::propagateBreakpoints(int after) {
     for (int i = 1; i <= after; ++i) {
       int cutPos = front_[i].end + Params::minWaste;
       if (cutPos > bp && isAdmissibleCutLine(cutPos))
-        propagate(i, cutPos);
+        propagate<true>(i, cutPos);
     }
     int firstCutPos = region_.minY() + Params::minYY;
     if (bp < firstCutPos && isAdmissibleCutLine(firstCutPos)) {
-      propagate(0, firstCutPos);
+      propagate<true>(0, firstCutPos);
     }
     int maxValid = 0;
     for (int i = 1; i <= after; ++i) {
@@ -230,7 +356,7 @@ void CutPacker::propagateBreakpoints(int after) {
         maxValid = i;
     }
     if (isAdmissibleCutLine(bp)) {
-      propagate(maxValid, bp);
+      propagate<true>(maxValid, bp);
     }
   }
 }
@@ -277,11 +403,14 @@ CutPacker::CutDescription CutPacker::countBacktrack() {
   return description;
 }
 
+template<bool HasDefects>
 bool CutPacker::isAdmissibleCutLine(int y) const {
   if (y == 0 || y == Params::heightPlates)
     return true;
   if (y < Params::minYY || y > Params::heightPlates - Params::minYY)
     return false;
+  if (!HasDefects)
+    return true;
   for (Defect d : defects_) {
     if (d.intersectsHorizontalLine(y))
       return false;
@@ -21,7 +21,7 @@ Problem IOProblem::read() {
 }
 
 void IOProblem::write(const Problem &pb) {
-  writeParams();
+  writeParams(pb);
   writeItems(pb.items());
   writeDefects(pb.defects());
 }
@@ -91,8 +91,8 @@ void IOProblem::readItem(const string &s, vector<Item> &items) {
   item.stack = item_fields[3];
   item.sequence = item_fields[4];
 
-  int minDim = min(item.width, item.height);
-  int maxDim = max(item.width, item.height);
+  int minDim = min(width, height);
+  int maxDim = max(width, height);
   int minMax = min(Params::maxXX, Params::heightPlates);
   int maxMax = max(Params::maxXX, Params::heightPlates);
 
@@ -146,10 +146,10 @@ vector<string> IOProblem::readCSVLine(const string &s) {
   return ret;
 }
 
-void IOProblem::writeParams() {
+void IOProblem::writeParams(const Problem &pb) {
   ofstream f(nameParams().c_str());
   f << "NAME;VALUE" << endl;
-  f << "nPlates;" << Params::nPlates << endl;
+  f << "nPlates;" << pb.nPlates() << endl;
   f << "widthPlates;" << Params::widthPlates << endl;
   f << "heightPlates;" << Params::heightPlates << endl;
   f << "minXX;" << Params::minXX << endl;
@@ -0,0 +1,100 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#include "lower_bound.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+long long LowerBound::areaUsage(const Problem &problem) {
+  return usedLength(problem) * Params::heightPlates;
+}
+
+double LowerBound::percentDensity(const Problem &problem) {
+  long long usage = areaUsage(problem);
+  if (usage <= 0) return 100.0;
+  long long itemArea = 0;
+  for (Item item : problem.items()) {
+    itemArea += item.area();
+  }
+  return 100.0 * itemArea / usage;
+}
+
+double LowerBound::percentGap(const Problem &problem, long long areaUsage) {
+  if (areaUsage <= 0) return 0.0;
+  return 100.0 * (areaUsage - LowerBound::areaUsage(problem)) / areaUsage;
+}
+
+long long LowerBound::usedLength(const Problem &problem) {
+  if (problem.items().empty()) return 0;
+
+  long long itemArea = 0;
+  long long maxSpan = Params::minXX;
+  long long highSpan = 0;
+  for (Item item : problem.items()) {
+    itemArea += item.area();
+    // Items are stored with their smallest dimension as width
+    maxSpan = max(maxSpan, (long long) item.width);
+    if (item.width > Params::heightPlates / 2)
+      highSpan += item.width;
+  }
+
+  // Fill the plates in order with the area of the items
+  long long areaLength = (long long) problem.nPlates() * Params::widthPlates;
+  long long remaining = itemArea;
+  for (int p = 0; p < problem.nPlates(); ++p) {
+    const vector<Defect> &defects = problem.plateDefects()[p];
+    long long available = (long long) Params::widthPlates * Params::heightPlates - defectArea(defects, Params::widthPlates);
+    if (remaining > available) {
+      remaining -= available;
+      continue;
+    }
+    // Narrowest part of the last plate with enough free area
+    int lo = 1;
+    int hi = Params::widthPlates;
+    while (lo < hi) {
+      int mid = (lo + hi) / 2;
+      if ((long long) mid * Params::heightPlates - defectArea(defects, mid) >= remaining)
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+    areaLength = (long long) p * Params::widthPlates + max(lo, Params::minXX);
+    break;
+  }
+
+  return max(areaLength, max(maxSpan, highSpan));
+}
+
+long long LowerBound::defectArea(const vector<Defect> &defects, int maxX) {
+  // Area of the union of the defects before maxX; there are few defects per plate, so a sweep along x is enough
+  vector<int> xs = {0, maxX};
+  for (const Defect &d : defects) {
+    xs.push_back(min(max(d.minX(), 0), maxX));
+    xs.push_back(min(max(d.maxX(), 0), maxX));
+  }
+  sort(xs.begin(), xs.end());
+  xs.erase(unique(xs.begin(), xs.end()), xs.end());
+
+  long long area = 0;
+  for (size_t i = 0; i + 1 < xs.size(); ++i) {
+    vector<pair<int, int> > ys;
+    for (const Defect &d : defects) {
+      if (d.minX() <= xs[i] && d.maxX() >= xs[i+1])
+        ys.emplace_back(max(d.minY(), 0), min(d.maxY(), Params::heightPlates));
+    }
+    sort(ys.begin(), ys.end());
+    int covered = 0;
+    int end = 0;
+    for (pair<int, int> y : ys) {
+      int begin = max(y.first, end);
+      if (y.second > begin) {
+        covered += y.second - begin;
+        end = y.second;
+      }
+    }
+    area += (long long) covered * (xs[i+1] - xs[i]);
+  }
+  return area;
+}
+
@@ -4,6 +4,10 @@
 #include "solver.hpp"
 #include "solution_checker.hpp"
 #include "sequence_packer.hpp"
+#include "batch_solver.hpp"
+#include "window_solver.hpp"
+#include "tracer.hpp"
+#include "perf_counters.hpp"
 #include "utils.hpp"
 
 #include <iostream>
@@ -51,6 +55,9 @@ po::options_description getAdvancedOptions() {
   desc.add_options()("initial", po::value<string>(),
                      "Initial solution file (.csv)");
 
+  desc.add_options()("manifest", po::value<string>(),
+                     "Manifest file listing several instances to solve with a shared time limit");
+
   desc.add_options()("stats", "Simply report statistics");
 
   return desc;
@@ -65,12 +72,20 @@ po::options_description getHiddenOptions() {
                     "Output verbosity");
   dev.add_options()("check", "Fail and report on violation");
   dev.add_options()("permissive", "Tolerate infeasible problems");
+  dev.add_options()("trace", po::value<string>(), "Write a timeline of the solver steps, moves and packings (Chrome trace .json)");
+  dev.add_options()("profile", po::value<string>(), "Write the time, moves and quality of each improvement (CSV, or JSON if the name ends with .json)");
+  dev.add_options()("perf-counters", "Report the hardware counters (cycles, instructions, cache and branch misses) of the packing kernels");
 
   po::options_description move("GCUT move options");
   move.add_options()("moves", po::value<size_t>()->default_value(1000000000llu),
                      "Move limit");
   move.add_options()("init-moves", po::value<size_t>()->default_value(1000llu),
                      "Initialization move limit");
+  move.add_options()("record-moves", po::value<string>(), "Write a binary log of the moves to replay them");
+  move.add_options()("replay", po::value<string>(), "Replay the moves of a log instead of solving; same problem, options and initial solution");
+  move.add_options()("replay-first", po::value<size_t>()->default_value(0llu), "First move replayed");
+  move.add_options()("replay-last", po::value<size_t>(), "Last move replayed");
+  move.add_options()("deterministic", "Same result for any number of threads, at the cost of some evaluations run again");
 
   po::options_description pack("GCUT packing options");
   pack.add_options()("exact-row-packings", "Solve 3-cuts packings exactly");
@@ -86,6 +101,7 @@ po::options_description getHiddenOptions() {
   po::options_description expe("GCUT experimental options");
   pack.add_options()("first-plate", po::value<int>(), "First plate to consider from the initial solution");
   pack.add_options()("last-plate" , po::value<int>(), "Last plate to consider from the initial solution");
+  pack.add_options()("window-plates", po::value<size_t>(), "Solve windows of this many consecutive plates as independent sub-problems");
   pack.add_options()("early-cancel" , po::value<bool>()->default_value(true), "Cancel non-improving moves early, without running the whole packing algorithm");
 
   desc.add(dev).add(move).add(pack).add(expe);
@@ -132,14 +148,15 @@ po::variables_map parseArguments(int argc, char **argv) {
   bool prefixPresent = fileOptionPresent(vm, "p");
   bool batchPresent  = fileOptionPresent(vm, "batch");
   bool defectPresent = fileOptionPresent(vm, "defects");
+  bool manifestPresent = fileOptionPresent(vm, "manifest");
 
   if (vm.count("name")) {
     cout << "S16" << endl;
-    if (!prefixPresent && !batchPresent)
+    if (!prefixPresent && !batchPresent && !manifestPresent)
       exit(0);
   }
 
-  if (!prefixPresent && !batchPresent) {
+  if (!prefixPresent && !batchPresent && !manifestPresent) {
     cout << "Missing input file" << endl << endl;
     cout << desc << endl;
     exit(1);
@@ -149,6 +166,16 @@ po::variables_map parseArguments(int argc, char **argv) {
     cout << visibleOptions << endl;
     exit(1);
   }
+  if (manifestPresent && (prefixPresent || batchPresent || defectPresent || vm.count("initial"))) {
+    cout << "--manifest option cannot be used with -p, --batch, --defects or --initial" << endl << endl;
+    cout << visibleOptions << endl;
+    exit(1);
+  }
+  if (vm.count("record-moves") && (manifestPresent || vm.count("window-plates"))) {
+    cout << "--record-moves option cannot be used with --manifest or --window-plates" << endl << endl;
+    cout << visibleOptions << endl;
+    exit(1);
+  }
 
   return vm;
 }
@@ -163,6 +190,10 @@ SolverParams buildParams(const po::variables_map &vm) {
   params.moveLimit = vm["moves"].as<size_t>();
   params.initializationRuns = vm["init-moves"].as<size_t>();
   params.earlyCancel = vm["early-cancel"].as<bool>();
+  params.deterministic = vm.count("deterministic");
+  if (vm.count("record-moves")) params.moveLogFile = vm["record-moves"].as<string>();
+  if (vm.count("profile")) params.profileFile = vm["profile"].as<string>();
+  if (vm.count("window-plates")) params.windowPlates = vm["window-plates"].as<size_t>();
 
   if (vm.count("exact-row-packings")) params.rowPacking = PackingOption::Exact;
   if (vm.count("diagnose-row-packings")) params.rowPacking = PackingOption::Diagnose;
@@ -184,7 +215,10 @@ void makeInitial(Problem &pb, Solution &initial, const po::variables_map &vm, co
     initialSequence.push_back(pb.items()[id]);
   }
 
-  initial = SequencePacker::run(pb, initialSequence, params);
+  // Single full packing: the other threads pack the next plates ahead of time
+  SolverParams packParams = params;
+  packParams.speculativeThreads = params.nbThreads > 1 ? params.nbThreads - 1 : 0;
+  initial = SequencePacker::run(pb, initialSequence, packParams);
 
   if (!vm.count("first-plate") && !vm.count("last-plate")) return;
 
@@ -192,49 +226,29 @@ void makeInitial(Problem &pb, Solution &initial, const po::variables_map &vm, co
   int lastPlate = vm.count("last-plate") ? min(vm["last-plate"].as<int>() + 1, initial.nPlates()) : initial.nPlates();
 
   // Now reduce the problem size; keep only the items that are on those plates
-  initial.plates.erase(initial.plates.begin() + lastPlate, initial.plates.end());
-  initial.plates.erase(initial.plates.begin(), initial.plates.begin() + firstPlate);
-
-  vector<Item> items;
-  vector<Defect> defects;
-
-  int itemId = 0;
-  for (PlateSolution &plate : initial.plates) {
-    for (CutSolution &cut: plate.cuts) {
-      for (RowSolution &row: cut.rows) {
-        for (ItemSolution &isol: row.items) {
-          Item item = pb.items()[isol.itemId];
-          item.id = itemId;
-          isol.itemId = itemId;
-          items.push_back(item);
-          ++itemId;
-        }
-      }
-    }
-  }
-
-  for (Defect defect : pb.defects()) {
-    if (defect.plateId < firstPlate) continue;
-    if (defect.plateId >= lastPlate) continue;
-    defect.plateId -= firstPlate;
-    defects.push_back(defect);
-  }
-
-  int stackId = 0;
-  map<int, int> stackIdMapping;
-  for (Item &item : items) {
-    if (!stackIdMapping.count(item.stack))
-      stackIdMapping.emplace(item.stack, stackId++);
-    item.stack = stackIdMapping[item.stack];
-  }
-
-  pb = Problem(items, defects);
+  WindowSolver::Window window = WindowSolver::extract(pb, initial, firstPlate, lastPlate);
+  pb = window.problem;
+  initial = window.solution;
 }
 
 void run(int argc, char** argv) {
   cout << fixed << setprecision(2);
   cerr << fixed << setprecision(2);
   po::variables_map vm = parseArguments(argc, argv);
+  if (fileOptionPresent(vm, "trace"))
+    Tracer::enable();
+  if (vm.count("perf-counters"))
+    PerfCounters::enable();
+
+  if (fileOptionPresent(vm, "manifest")) {
+    vector<BatchInstance> instances = BatchSolver::readManifest(vm["manifest"].as<string>());
+    BatchSolver::run(instances, buildParams(vm), vm.count("permissive"));
+    if (fileOptionPresent(vm, "trace"))
+      Tracer::write(vm["trace"].as<string>());
+    if (PerfCounters::enabled())
+      PerfCounters::report();
+    return;
+  }
 
   string batchFile;
   string defectFile;
@@ -258,7 +272,18 @@ void run(int argc, char** argv) {
   Solution initial;
   makeInitial(pb, initial, vm, params);
 
-  Solution solution = Solver::run(pb, params, initial);
+  Solution solution;
+  if (fileOptionPresent(vm, "replay")) {
+    size_t firstMove = vm["replay-first"].as<size_t>();
+    size_t lastMove = vm.count("replay-last") ? vm["replay-last"].as<size_t>() + 1 : numeric_limits<size_t>::max();
+    solution = Solver::replay(pb, params, initial, vm["replay"].as<string>(), firstMove, lastMove);
+  }
+  else if (vm.count("window-plates")) {
+    solution = WindowSolver::run(pb, params, initial);
+  }
+  else {
+    solution = Solver::run(pb, params, initial);
+  }
 
   if (params.verbosity >= 3)
     solution.report();
@@ -267,6 +292,10 @@ void run(int argc, char** argv) {
 
   if (vm.count("o"))
     solution.write(vm["o"].as<string>());
+  if (fileOptionPresent(vm, "trace"))
+    Tracer::write(vm["trace"].as<string>());
+  if (PerfCounters::enabled())
+    PerfCounters::report();
 }
 
 int main(int argc, char** argv) {
@@ -6,7 +6,6 @@
 #include "solution_checker.hpp"
 #include "ordering_heuristic.hpp"
 
-#include <unordered_map>
 #include <algorithm>
 #include <cassert>
 #include <sstream>
@@ -14,6 +13,9 @@
 
 using namespace std;
 
+thread_local uint64_t Move::evaluatedHash_ = 0;
+thread_local bool Move::skippedKnown_ = false;
+
 Move::Move()
 : nViolation_(0)
 , nImprovement_(0)
@@ -23,145 +25,98 @@ Move::Move()
 , nCommonPlates_ (0)
 , nPrunedPlates_(0)
 , nDifferentPlates_(0)
+, traceName_("Move")
 {
 }
 
-vector<vector<Item> > Move::extractItemItems(const Solution &solution) const {
-  vector<vector<Item> > items;
-  for (const PlateSolution &plate: solution.plates) {
-    for (const CutSolution &cut: plate.cuts) {
-      for (const RowSolution &row: cut.rows) {
-        for (ItemSolution item : row.items) {
-          vector<Item> itemSeq = {problem().items()[item.itemId]};
-          items.push_back(itemSeq);
-        }
-      }
-    }
+vector<int> Move::blockOrder(const vector<int> &offsets) {
+  vector<int> order(offsets.size() - 1);
+  for (int i = 0; i < (int) order.size(); ++i) {
+    order[i] = i;
   }
-  return items;
+  return order;
 }
 
-vector<vector<Item> > Move::extractRowItems(const Solution &solution) const {
-  vector<vector<Item> > rows;
-  for (const PlateSolution &plate: solution.plates) {
-    for (const CutSolution &cut: plate.cuts) {
-      for (const RowSolution &row: cut.rows) {
-        rows.push_back(row.sequence(problem()));
-      }
-    }
-  }
-  return rows;
-}
+Solution Move::mergeRepairRun(const vector<int> &offsets, const vector<int> &order) {
+  vector<int> merged = mergeSequence(offsets, order);
 
-vector<vector<Item> > Move::extractCutItems(const Solution &solution) const {
-  vector<vector<Item> > cuts;
-  for (const PlateSolution &plate: solution.plates) {
-    for (const CutSolution &cut: plate.cuts) {
-      cuts.push_back(cut.sequence(problem()));
-    }
-  }
-  return cuts;
-}
+  // Only the blocks between the first and the last moved one are changed
+  int first = 0;
+  while (first < (int) order.size() && order[first] == first) ++first;
+  int last = order.size();
+  while (last > first && order[last - 1] == last - 1) --last;
+  int begin = offsets[first];
+  int end = offsets[last];
 
-vector<vector<Item> > Move::extractPlateItems(const Solution &solution) const {
-  vector<vector<Item> > plates;
-  for (const PlateSolution &plate: solution.plates) {
-    plates.push_back(plate.sequence(problem()));
+  if (!view().valid()) {
+    // The whole sequence needs to be repaired, for example after an invalid initial solution
+    repairSequence(merged);
+    return runSequence(merged);
   }
-  return plates;
-}
-
-vector<ItemSolution> Move::extractItems(const Solution &solution) const {
-  vector<ItemSolution> items;
-  for (const PlateSolution &plate: solution.plates) {
-    for (const CutSolution &cut: plate.cuts) {
-      for (const RowSolution &row: cut.rows) {
-        for (ItemSolution item : row.items) {
-          items.push_back(item);
-        }
-      }
-    }
-  }
-  return items;
+
+  // The window holds the same items as before, so repairing it is enough to obtain a valid sequence
+  repairSequence(merged, begin, end);
+  return runValidSequence(merged, begin, end);
 }
 
-vector<RowSolution> Move::extractRows(const Solution &solution) const {
-  vector<RowSolution> rows;
-  for (const PlateSolution &plate: solution.plates) {
-    for (const CutSolution &cut: plate.cuts) {
-      for (const RowSolution &row: cut.rows) {
-        rows.push_back(row);
-      }
-    }
-  }
-  return rows;
+Solution Move::runSequence(const vector<int> &sequence) {
+  return runSequence(sequence, 0, sequence.size());
 }
 
-vector<CutSolution> Move::extractCuts(const Solution &solution) const {
-  vector<CutSolution> cuts;
-  for (const PlateSolution &plate: solution.plates) {
-    for (const CutSolution &cut: plate.cuts) {
-      cuts.push_back(cut);
+Solution Move::runSequence(const vector<int> &sequence, int begin, int end) {
+  if (!sequenceValid(sequence))
+    return Solution();
+  return runValidSequence(sequence, begin, end);
+}
+
+Solution Move::runValidSequence(const vector<int> &sequence, int begin, int end) {
+  // Narrow the window to the items that actually differ from the incumbent
+  const vector<int> &existing = view().sequence();
+  int n = sequence.size();
+  end = min(end, min(n, (int) existing.size()));
+  while (begin < end && existing[begin] == sequence[begin]) ++begin;
+  while (end > begin && existing[end - 1] == sequence[end - 1]) --end;
+  int beginDiff = begin < end ? begin : n;
+  int endDiff = begin < end ? end : n;
+
+  if (params().skipKnownSequences) {
+    // The same dimensions in the same order give the same packing
+    uint64_t hash = sequenceHash(sequence, begin, end);
+    if (solver_->knownSequence(hash)) {
+      skippedKnown_ = true;
+      return Solution();
     }
+    evaluatedHash_ = hash;
   }
-  return cuts;
+
+  return SequencePacker::run(problem(), problem().itemSequence(sequence), params(), solution(), beginDiff, endDiff);
 }
 
-vector<PlateSolution> Move::extractPlates(const Solution &solution) const {
-  vector<PlateSolution> plates;
-  for (const PlateSolution &plate: solution.plates) {
-    plates.push_back(plate);
-  }
-  return plates;
-}
-
-int Move::plateIdOfRow(int rowId) const {
-  int id = 0;
-  for (int i = 0; i < (int) solution().plates.size(); ++i) {
-    const PlateSolution &plate = solution().plates[i];
-    for (const CutSolution &cut: plate.cuts) {
-      for (const RowSolution &row: cut.rows) {
-        if (rowId == id++)
-          return i;
-      }
+uint64_t Move::sequenceHash(const vector<int> &sequence, int begin, int end) const {
+  const vector<Item> &items = problem().items();
+  const vector<int> &existing = view().sequence();
+  uint64_t hash = 0;
+  if (existing.size() == sequence.size()) {
+    // Update the incumbent's hash where the sequences differ
+    hash = view().hash();
+    for (int i = begin; i < end; ++i) {
+      hash += SolutionView::itemHash(i, items[sequence[i]]) - SolutionView::itemHash(i, items[existing[i]]);
     }
   }
-  assert (false);
-  return -1;
-}
-
-int Move::plateIdOfCut(int cutId) const {
-  int id = 0;
-  for (int i = 0; i < (int) solution().plates.size(); ++i) {
-    const PlateSolution &plate = solution().plates[i];
-    for (const CutSolution &cut: plate.cuts) {
-      if (cutId == id++)
-        return i;
+  else {
+    for (int i = 0; i < (int) sequence.size(); ++i) {
+      hash += SolutionView::itemHash(i, items[sequence[i]]);
     }
   }
-  assert (false);
-  return -1;
-}
-
-Solution Move::mergeRepairRun(const vector<vector<Item> > &sequence) {
-  vector<Item> merged = mergeSequence(sequence);
-  repairSequence(merged);
-  return runSequence(merged);
+  return hash;
 }
 
-Solution Move::runSequence(const vector<Item> &sequence) {
-  if (!sequenceValid(sequence))
-    return Solution();
-
-  return SequencePacker::run(problem(), sequence, params(), solution());
-}
-
-void randomInsert(vector<vector<Item> > &vec, mt19937 &rgen, int maxRange) {
+void randomInsert(vector<int> &vec, mt19937 &rgen, int maxRange) {
   if (vec.size() <= 2)
     return;
   uniform_int_distribution<int> dist1(0, vec.size()-1);
   int pickedIndex = dist1(rgen);
-  vector<Item> picked = vec[pickedIndex];
+  int picked = vec[pickedIndex];
   vec.erase(vec.begin() + pickedIndex);
 
   uniform_int_distribution<int> dist2(max(pickedIndex - maxRange, 0), min(pickedIndex + maxRange - 1, (int) vec.size()-2));
@@ -171,7 +126,7 @@ void randomInsert(vector<vector<Item> > &vec, mt19937 &rgen, int maxRange) {
   vec.insert(vec.begin() + insertionPoint, picked);
 }
 
-void randomSwap(vector<vector<Item> > &vec, mt19937 &rgen, int maxRange) {
+void randomSwap(vector<int> &vec, mt19937 &rgen, int maxRange) {
   if (vec.size() <= 2)
     return;
   uniform_int_distribution<int> dist1(0, vec.size()-1);
@@ -185,7 +140,7 @@ void randomSwap(vector<vector<Item> > &vec, mt19937 &rgen, int maxRange) {
   swap(vec[i0], vec[i1]);
 }
 
-void randomRangeSwap(vector<vector<Item> > &vec, mt19937 &rgen) {
+void randomRangeSwap(vector<int> &vec, mt19937 &rgen) {
   if (vec.size() <= 4)
     return;
   uniform_int_distribution<int> dist(0, vec.size()-1);
@@ -201,7 +156,7 @@ void randomRangeSwap(vector<vector<Item> > &vec, mt19937 &rgen) {
   int b2 = lims[2];
   int e2 = lims[3];
 
-  vector<vector<Item> > ret;
+  vector<int> ret;
   for (int i = 0; i < b1; ++i)
     ret.push_back(vec[i]);
   for (int i = b2; i < e2; ++i)
@@ -216,7 +171,7 @@ void randomRangeSwap(vector<vector<Item> > &vec, mt19937 &rgen) {
   swap(vec, ret);
 }
 
-void randomMirror(vector<vector<Item> > &vec, mt19937 &rgen, int maxWidth) {
+void randomMirror(vector<int> &vec, mt19937 &rgen, int maxWidth) {
   assert (maxWidth >= 3);
   if (vec.size() <= 3)
     return;
@@ -228,7 +183,7 @@ void randomMirror(vector<vector<Item> > &vec, mt19937 &rgen, int maxWidth) {
   reverse(vec.begin() + begin, vec.begin() + begin + width);
 }
 
-void randomAdjacentSwap(vector<vector<Item> > &vec, mt19937 &rgen) {
+void randomAdjacentSwap(vector<int> &vec, mt19937 &rgen) {
   if (vec.size() < 2)
     return;
   uniform_int_distribution<int> dist(0, vec.size()-2);
@@ -236,59 +191,140 @@ void randomAdjacentSwap(vector<vector<Item> > &vec, mt19937 &rgen) {
   swap(vec[i], vec[i + 1]);
 }
 
-vector<Item> Move::mergeSequence(const vector<vector<Item> > &vecvec) {
-  vector<Item> ret;
-  for (const vector<Item> &vec : vecvec) {
-    for (Item item : vec) {
-      ret.push_back(item);
-    }
+// Variants for single items, that never exchange two items of the same class since it would not change the packing
+void randomItemInsert(vector<int> &vec, mt19937 &rgen, int maxRange, const vector<int> &classes) {
+  if (vec.size() <= 2)
+    return;
+  int n = vec.size();
+  uniform_int_distribution<int> dist1(0, n-1);
+  int pickedIndex = dist1(rgen);
+
+  // Inserting the item among identical ones gives the same sequence
+  int cls = classes[pickedIndex];
+  int prevDiff = pickedIndex - 1;
+  while (prevDiff >= 0 && classes[prevDiff] == cls) --prevDiff;
+  int nextDiff = pickedIndex + 1;
+  while (nextDiff < n && classes[nextDiff] == cls) ++nextDiff;
+
+  int nBefore = max(prevDiff - max(pickedIndex - maxRange, 0) + 1, 0);
+  int nAfter = max(min(pickedIndex + maxRange, n - 1) - nextDiff + 1, 0);
+  if (nBefore + nAfter == 0)
+    return;
+  uniform_int_distribution<int> dist2(0, nBefore + nAfter - 1);
+  int roll = dist2(rgen);
+  int insertionPoint = roll < nBefore ? prevDiff - roll : nextDiff + roll - nBefore;
+
+  int picked = vec[pickedIndex];
+  vec.erase(vec.begin() + pickedIndex);
+  vec.insert(vec.begin() + insertionPoint, picked);
+}
+
+void randomItemSwap(vector<int> &vec, mt19937 &rgen, int maxRange, const vector<int> &classes) {
+  if (vec.size() <= 2)
+    return;
+  int n = vec.size();
+  uniform_int_distribution<int> dist1(0, n-1);
+  int i0 = dist1(rgen);
+
+  vector<int> candidates;
+  for (int i = max(i0 - maxRange, 0); i <= min(i0 + maxRange, n - 1); ++i) {
+    if (classes[i] != classes[i0])
+      candidates.push_back(i);
+  }
+  if (candidates.empty())
+    return;
+  uniform_int_distribution<int> dist2(0, candidates.size() - 1);
+  int i1 = candidates[dist2(rgen)];
+
+  swap(vec[i0], vec[i1]);
+}
+
+void randomItemAdjacentSwap(vector<int> &vec, mt19937 &rgen, const vector<int> &classes) {
+  vector<int> candidates;
+  for (int i = 0; i + 1 < (int) vec.size(); ++i) {
+    if (classes[i] != classes[i + 1])
+      candidates.push_back(i);
+  }
+  if (candidates.empty())
+    return;
+  uniform_int_distribution<int> dist(0, candidates.size() - 1);
+  int i = candidates[dist(rgen)];
+  swap(vec[i], vec[i + 1]);
+}
+
+vector<int> Move::mergeSequence(const vector<int> &offsets, const vector<int> &order) const {
+  const vector<int> &sequence = view().sequence();
+  vector<int> ret;
+  ret.reserve(sequence.size());
+  for (int block : order) {
+    ret.insert(ret.end(), sequence.begin() + offsets[block], sequence.begin() + offsets[block + 1]);
   }
   return ret;
 }
 
-void Move::repairSequence(vector<Item> &sequence) const {
+void Move::repairSequence(vector<int> &sequence) const {
   // Reorder the items in each stack so they meet the precedence constraints
-  vector<Item> result;
+  const vector<Item> &items = problem().items();
 
   // Create the stacks from the sequences in order to tolerate partial sequences
-  vector<vector<Item> > stacks(problem().stackItems().size());
-  for (Item item : sequence) {
-    stacks[item.stack].push_back(item);
+  vector<vector<int> > stacks(problem().stackItems().size());
+  for (int id : sequence) {
+    stacks[items[id].stack].push_back(id);
   }
-  for (vector<Item> &stack : stacks) {
-    sort(stack.begin(), stack.end(), [](Item a, Item b) { return a.sequence < b.sequence; });
+  for (vector<int> &stack : stacks) {
+    sort(stack.begin(), stack.end(), [&items](int a, int b) { return items[a].sequence < items[b].sequence; });
   }
 
   vector<int> stackCounts(problem().stackItems().size(), 0);
-  for (Item item : sequence) {
-    int stack = item.stack;
+  for (int &id : sequence) {
+    int stack = items[id].stack;
     int index = stackCounts[stack]++;
     assert (index < (int) stacks[stack].size());
-    result.push_back(stacks[stack][index]);
+    id = stacks[stack][index];
   }
+}
 
-  swap(sequence, result);
+void Move::repairSequence(vector<int> &sequence, int begin, int end) const {
+  // Sort the items of each stack among the positions they occupy in the window
+  const vector<Item> &items = problem().items();
+  vector<int> positions(end - begin);
+  for (int i = 0; i < end - begin; ++i) {
+    positions[i] = begin + i;
+  }
+  vector<int> ids(sequence.begin() + begin, sequence.begin() + end);
+  sort(positions.begin(), positions.end(), [&](int a, int b) {
+    int stackA = items[sequence[a]].stack;
+    int stackB = items[sequence[b]].stack;
+    return stackA < stackB || (stackA == stackB && a < b);
+  });
+  sort(ids.begin(), ids.end(), [&items](int a, int b) {
+    return items[a].stack < items[b].stack || (items[a].stack == items[b].stack && items[a].sequence < items[b].sequence);
+  });
+  for (int i = 0; i < end - begin; ++i) {
+    sequence[positions[i]] = ids[i];
+  }
 }
 
-bool Move::sequenceValid(const vector<Item> &sequence) const {
+bool Move::sequenceValid(const vector<int> &sequence) const {
   if (sequence.size() != problem().items().size())
     return false;
 
-  unordered_map<int, int> itemPositions;
+  // Item ids are their index in the problem
+  vector<int> itemPositions(problem().items().size(), -1);
   int pos = 0;
-  for (Item item : sequence) {
-    itemPositions[item.id] = pos++;
+  for (int id : sequence) {
+    itemPositions[id] = pos++;
   }
 
   for (const vector<Item> &sequence : problem().stackItems()) {
     for (unsigned i = 0; i + 1 < sequence.size(); ++i) {
-      int ida = sequence[i].id;
-      int idb = sequence[i+1].id;
-      if (itemPositions.count(idb) == 0)
+      int posa = itemPositions[sequence[i].id];
+      int posb = itemPositions[sequence[i+1].id];
+      if (posb == -1)
         continue;
-      if (itemPositions.count(ida) == 0)
+      if (posa == -1)
         return false;
-      if (itemPositions[ida] > itemPositions[idb])
+      if (posa > posb)
         return false;
     }
   }
@@ -296,23 +332,23 @@ bool Move::sequenceValid(const vector<Item> &sequence) const {
   return true;
 }
 
-void Move::checkSequenceValid(const vector<Item> &sequence) const {
+void Move::checkSequenceValid(const vector<int> &sequence) const {
   assert (sequence.size() == problem().items().size());
 
-  unordered_map<int, int> itemPositions;
+  vector<int> itemPositions(problem().items().size(), -1);
   int pos = 0;
-  for (Item item : sequence) {
-    itemPositions[item.id] = pos++;
+  for (int id : sequence) {
+    itemPositions[id] = pos++;
   }
 
   for (const vector<Item> &sequence : problem().stackItems()) {
     for (unsigned i = 0; i + 1 < sequence.size(); ++i) {
-      int ida = sequence[i].id;
-      int idb = sequence[i+1].id;
-      if (itemPositions.count(idb) == 0)
+      int posa = itemPositions[sequence[i].id];
+      int posb = itemPositions[sequence[i+1].id];
+      if (posb == -1)
         continue;
-      assert (itemPositions.count(ida) != 0);
-      assert (itemPositions[ida] <= itemPositions[idb]);
+      assert (posa != -1);
+      assert (posa <= posb);
     }
   }
 }
@@ -322,11 +358,15 @@ Solution Shuffle::apply(mt19937& rgen) {
   if (windowSize_ == 0) {
     sequence = OrderingHeuristic::orderShuffle(problem(), rgen, chunkSize_);
   } else {
-    vector<Item> initial = solution().sequence(problem());
+    vector<Item> initial = problem().itemSequence(view().sequence());
     sequence = OrderingHeuristic::orderShuffle(problem(), rgen,
         initial, chunkSize_, windowSize_);
   }
-  return runSequence(sequence);
+  vector<int> ids;
+  for (Item item : sequence) {
+    ids.push_back(item.id);
+  }
+  return runSequence(ids);
 }
 
 string Shuffle::name() const {
@@ -339,87 +379,101 @@ string Shuffle::name() const {
 }
 
 Solution ItemInsert::apply(mt19937& rgen) {
-  vector<vector<Item> > items = extractItemItems(solution());
-  randomInsert(items, rgen, 10);
-  return mergeRepairRun(items);
+  const vector<int> &offsets = view().itemOffsets();
+  vector<int> items = blockOrder(offsets);
+  randomItemInsert(items, rgen, 10, view().classes());
+  return mergeRepairRun(offsets, items);
 }
 
 Solution RowInsert::apply(mt19937& rgen) {
-  vector<vector<Item> > rows = extractRowItems(solution());
+  const vector<int> &offsets = view().rowOffsets();
+  vector<int> rows = blockOrder(offsets);
   randomInsert(rows, rgen, 5);
-  return mergeRepairRun(rows);
+  return mergeRepairRun(offsets, rows);
 }
 
 Solution CutInsert::apply(mt19937& rgen) {
-  vector<vector<Item> > cuts = extractCutItems(solution());
+  const vector<int> &offsets = view().cutOffsets();
+  vector<int> cuts = blockOrder(offsets);
   randomInsert(cuts, rgen, 3);
-  return mergeRepairRun(cuts);
+  return mergeRepairRun(offsets, cuts);
 }
 
 Solution PlateInsert::apply(mt19937& rgen) {
-  vector<vector<Item> > plates = extractPlateItems(solution());
+  const vector<int> &offsets = view().plateOffsets();
+  vector<int> plates = blockOrder(offsets);
   randomInsert(plates, rgen, 2);
-  return mergeRepairRun(plates);
+  return mergeRepairRun(offsets, plates);
 }
 
 Solution ItemSwap::apply(mt19937& rgen) {
-  vector<vector<Item> > items = extractItemItems(solution());
-  randomSwap(items, rgen, 10);
-  return mergeRepairRun(items);
+  const vector<int> &offsets = view().itemOffsets();
+  vector<int> items = blockOrder(offsets);
+  randomItemSwap(items, rgen, 10, view().classes());
+  return mergeRepairRun(offsets, items);
 }
 
 Solution RowSwap::apply(mt19937& rgen) {
-  vector<vector<Item> > rows = extractRowItems(solution());
+  const vector<int> &offsets = view().rowOffsets();
+  vector<int> rows = blockOrder(offsets);
   randomSwap(rows, rgen, 5);
-  return mergeRepairRun(rows);
+  return mergeRepairRun(offsets, rows);
 }
 
 Solution CutSwap::apply(mt19937& rgen) {
-  vector<vector<Item> > cuts = extractCutItems(solution());
+  const vector<int> &offsets = view().cutOffsets();
+  vector<int> cuts = blockOrder(offsets);
   randomSwap(cuts, rgen, 3);
-  return mergeRepairRun(cuts);
+  return mergeRepairRun(offsets, cuts);
 }
 
 Solution PlateSwap::apply(mt19937& rgen) {
-  vector<vector<Item> > plates = extractPlateItems(solution());
+  const vector<int> &offsets = view().plateOffsets();
+  vector<int> plates = blockOrder(offsets);
   randomSwap(plates, rgen, 2);
-  return mergeRepairRun(plates);
+  return mergeRepairRun(offsets, plates);
 }
 
 Solution RangeSwap::apply(mt19937& rgen) {
-  vector<vector<Item> > items = extractItemItems(solution());
+  const vector<int> &offsets = view().itemOffsets();
+  vector<int> items = blockOrder(offsets);
   randomRangeSwap(items, rgen);
-  return mergeRepairRun(items);
+  return mergeRepairRun(offsets, items);
 }
 
 Solution AdjacentItemSwap::apply(mt19937& rgen) {
-  vector<vector<Item> > items = extractItemItems(solution());
-  randomAdjacentSwap(items, rgen);
-  return mergeRepairRun(items);
+  const vector<int> &offsets = view().itemOffsets();
+  vector<int> items = blockOrder(offsets);
+  randomItemAdjacentSwap(items, rgen, view().classes());
+  return mergeRepairRun(offsets, items);
 }
 
 Solution AdjacentRowSwap::apply(mt19937& rgen) {
-  vector<vector<Item> > rows = extractRowItems(solution());
+  const vector<int> &offsets = view().rowOffsets();
+  vector<int> rows = blockOrder(offsets);
   randomAdjacentSwap(rows, rgen);
-  return mergeRepairRun(rows);
+  return mergeRepairRun(offsets, rows);
 }
 
 Solution AdjacentCutSwap::apply(mt19937& rgen) {
-  vector<vector<Item> > cuts = extractCutItems(solution());
+  const vector<int> &offsets = view().cutOffsets();
+  vector<int> cuts = blockOrder(offsets);
   randomAdjacentSwap(cuts, rgen);
-  return mergeRepairRun(cuts);
+  return mergeRepairRun(offsets, cuts);
 }
 
 Solution AdjacentPlateSwap::apply(mt19937& rgen) {
-  vector<vector<Item> > plates = extractPlateItems(solution());
+  const vector<int> &offsets = view().plateOffsets();
+  vector<int> plates = blockOrder(offsets);
   randomAdjacentSwap(plates, rgen);
-  return mergeRepairRun(plates);
+  return mergeRepairRun(offsets, plates);
 }
 
 Solution Mirror::apply(mt19937& rgen) {
-  vector<vector<Item> > items = extractItemItems(solution());
+  const vector<int> &offsets = view().itemOffsets();
+  vector<int> items = blockOrder(offsets);
   randomMirror(items, rgen, width_);
-  return mergeRepairRun(items);
+  return mergeRepairRun(offsets, items);
 }
 
 string Mirror::name() const {
@@ -0,0 +1,46 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#include "move_log.hpp"
+
+#include <fstream>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+const char magic[8] = {'R', 'O', 'A', 'D', 'M', 'V', '0', '1'};
+}
+
+void MoveLog::write(const string &fileName) const {
+  ofstream f(fileName, ios::binary);
+  if (f.fail())
+    throw runtime_error("Couldn't open file \"" + fileName + "\".");
+  uint64_t nRecords = records.size();
+  f.write(magic, sizeof(magic));
+  f.write((const char*) &seed, sizeof(seed));
+  f.write((const char*) &nItems, sizeof(nItems));
+  f.write((const char*) &nRecords, sizeof(nRecords));
+  f.write((const char*) records.data(), nRecords * sizeof(MoveRecord));
+}
+
+MoveLog MoveLog::read(const string &fileName) {
+  ifstream f(fileName, ios::binary);
+  if (f.fail())
+    throw runtime_error("Couldn't open file \"" + fileName + "\".");
+  char header[sizeof(magic)];
+  uint64_t nRecords = 0;
+  MoveLog log;
+  f.read(header, sizeof(header));
+  f.read((char*) &log.seed, sizeof(log.seed));
+  f.read((char*) &log.nItems, sizeof(log.nItems));
+  f.read((char*) &nRecords, sizeof(nRecords));
+  if (f.fail() || memcmp(header, magic, sizeof(magic)) != 0)
+    throw runtime_error("\"" + fileName + "\" is not a move log.");
+  log.records.resize(nRecords);
+  f.read((char*) log.records.data(), nRecords * sizeof(MoveRecord));
+  if (f.fail())
+    throw runtime_error("The move log \"" + fileName + "\" is truncated.");
+  return log;
+}
+
@@ -57,6 +57,8 @@ void OrderingHeuristic::init() {
   nLeftover_ = 0;
   for (const vector<Item> &left : leftover_) {
     nLeftover_ += left.size();
+    topWidths_.push_back(left.back().width);
+    topHeights_.push_back(left.back().height);
   }
 }
 
@@ -66,27 +68,37 @@ void OrderingHeuristic::init(const std::vector<Item> &sequence, int begin, int e
   init();
 }
 
-int OrderingHeuristic::wasteEstimate(int h1, int w1, int h2, int w2) const {
-  if (h1 == h2) {
-    return 0;
-  }
-  else if (h1 > h2) {
-    int waste = max(h1 - h2, wasteThreshold_);
-    return w2 * waste;
-  }
-  else {
-    int waste = max(h2 - h1, wasteThreshold_);
-    return w1 * waste;
-  }
+namespace {
+// Estimates how much waste putting two item sides together will generate; written without branches so that loops over the stacks are vectorized
+inline int wasteEstimate(int h1, int w1, int h2, int w2, int wasteThreshold) {
+  int diff = h1 > h2 ? h1 - h2 : h2 - h1;
+  int width = h1 > h2 ? w2 : w1;
+  int waste = width * (diff > wasteThreshold ? diff : wasteThreshold);
+  return diff == 0 ? 0 : waste;
+}
 }
 
-int OrderingHeuristic::wasteEstimate(const Item& item1, const Item& item2) const {
-  // Estimates how much waste putting those two elements together will generate
-  int wasteVV = wasteEstimate(item1.height, item1.width, item2.height, item2.width);
-  int wasteHV = wasteEstimate(item1.width, item1.height, item2.height, item2.width);
-  int wasteVH = wasteEstimate(item1.height, item1.width, item2.width, item2.height);
-  int wasteHH = wasteEstimate(item1.width, item1.height, item2.width, item2.height);
-  return min({wasteVV, wasteHV, wasteVH, wasteHH});
+void OrderingHeuristic::computeWastes(const Item &item) {
+  // Best orientation of the item against the next item of each stack
+  int n = topWidths_.size();
+  wastes_.resize(n);
+  const int *widths = topWidths_.data();
+  const int *heights = topHeights_.data();
+  int *wastes = wastes_.data();
+  int w1 = item.width;
+  int h1 = item.height;
+  int t = wasteThreshold_;
+  for (int i = 0; i < n; ++i) {
+    int w2 = widths[i];
+    int h2 = heights[i];
+    int wasteVV = wasteEstimate(h1, w1, h2, w2, t);
+    int wasteHV = wasteEstimate(w1, h1, h2, w2, t);
+    int wasteVH = wasteEstimate(h1, w1, w2, h2, t);
+    int wasteHH = wasteEstimate(w1, h1, w2, h2, t);
+    int best1 = wasteVV < wasteHV ? wasteVV : wasteHV;
+    int best2 = wasteVH < wasteHH ? wasteVH : wasteHH;
+    wastes[i] = best1 < best2 ? best1 : best2;
+  }
 }
 
 void OrderingHeuristic::takeFirstStackElement(int stackInd) {
@@ -95,9 +107,19 @@ void OrderingHeuristic::takeFirstStackElement(int stackInd) {
   leftover_[stackInd].pop_back();
   --nLeftover_;
 
-  // Remove the stack if empty
-  if (leftover_[stackInd].empty())
-    leftover_.erase(leftover_.begin() + stackInd);
+  if (!leftover_[stackInd].empty()) {
+    topWidths_[stackInd] = leftover_[stackInd].back().width;
+    topHeights_[stackInd] = leftover_[stackInd].back().height;
+    return;
+  }
+
+  // Remove the stack if empty, replacing it by the last one
+  swap(leftover_[stackInd], leftover_.back());
+  leftover_.pop_back();
+  topWidths_[stackInd] = topWidths_.back();
+  topWidths_.pop_back();
+  topHeights_[stackInd] = topHeights_.back();
+  topHeights_.pop_back();
 }
 
 void OrderingHeuristic::takeFromRandomStack() {
@@ -108,22 +130,30 @@ void OrderingHeuristic::takeFromRandomStack() {
 void OrderingHeuristic::takeFromBestStack() {
   assert (!ordering_.empty());
   assert (!leftover_.empty());
-  Item lastItem = ordering_.back();
-  std::vector<int> candidates;
-  int bestWaste = -1;
-  for (int i = 0; i < (int) leftover_.size(); ++i) {
-    assert (!leftover_[i].empty());
-    int curWaste = wasteEstimate(lastItem, leftover_[i].back());
-    if (candidates.empty() || curWaste < bestWaste) {
-      candidates.clear();
-      candidates.push_back(i);
-      bestWaste = curWaste;
-    }
-    else if (curWaste == bestWaste) {
+  computeWastes(ordering_.back());
+  int bestWaste = *min_element(wastes_.begin(), wastes_.end());
+  vector<int> candidates;
+  for (int i = 0; i < (int) wastes_.size(); ++i) {
+    if (wastes_[i] == bestWaste)
       candidates.push_back(i);
-    }
   }
   assert (!candidates.empty());
+
+  // Stacks with identical next items lead to equivalent orderings: keep the one with the most items left
+  const vector<int> &classes = problem_.itemClasses();
+  sort(candidates.begin(), candidates.end(), [&](int a, int b) {
+    int classA = classes[leftover_[a].back().id];
+    int classB = classes[leftover_[b].back().id];
+    if (classA != classB)
+      return classA < classB;
+    if (leftover_[a].size() != leftover_[b].size())
+      return leftover_[a].size() > leftover_[b].size();
+    return a < b;
+  });
+  candidates.erase(unique(candidates.begin(), candidates.end(), [&](int a, int b) {
+    return classes[leftover_[a].back().id] == classes[leftover_[b].back().id];
+  }), candidates.end());
+
   uniform_int_distribution<int> selDist(0, candidates.size() - 1);
   takeFirstStackElement(candidates[selDist(rgen_)]);
 }
@@ -148,6 +178,8 @@ void OrderingHeuristic::orderShuffle(int chunkSize) {
 
   // Cleanup
   leftover_.clear();
+  topWidths_.clear();
+  topHeights_.clear();
   before_.clear();
   after_.clear();
 }
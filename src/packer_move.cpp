@@ -15,47 +15,43 @@ using namespace std;
 
 namespace {
 
-void findCandidatesBefore(vector<Item> &candidates, const vector<vector<Item> > &all, int subseqId, int maxArea) {
+void findCandidatesBefore(vector<int> &candidates, const Problem &problem, const vector<int> &sequence, int begin, int maxArea) {
   set<int> stackSeen;
-  for (int i = subseqId - 1; i >= 0; --i) {
-    for (int j = all[i].size() - 1; j >= 0; --j) {
-      Item item = all[i][j];
-      if (stackSeen.count(item.stack))
-        continue;
-      stackSeen.insert(item.stack);
-      if (item.area() > maxArea)
-        continue;
-      candidates.push_back(item);
-    }
+  for (int i = begin - 1; i >= 0; --i) {
+    Item item = problem.items()[sequence[i]];
+    if (stackSeen.count(item.stack))
+      continue;
+    stackSeen.insert(item.stack);
+    if (item.area() > maxArea)
+      continue;
+    candidates.push_back(item.id);
   }
 }
 
-void findCandidatesAfter(vector<Item> &candidates, const vector<vector<Item> > &all, int subseqId, int maxArea) {
+void findCandidatesAfter(vector<int> &candidates, const Problem &problem, const vector<int> &sequence, int end, int maxArea) {
   set<int> stackSeen;
-  for (int i = subseqId + 1; i < (int) all.size(); ++i) {
-    for (int j = 0; j < (int) all[i].size(); ++j) {
-      Item item = all[i][j];
-      if (stackSeen.count(item.stack))
-        continue;
-      stackSeen.insert(item.stack);
-      if (item.area() > maxArea)
-        continue;
-      candidates.push_back(item);
-    }
+  for (int i = end; i < (int) sequence.size(); ++i) {
+    Item item = problem.items()[sequence[i]];
+    if (stackSeen.count(item.stack))
+      continue;
+    stackSeen.insert(item.stack);
+    if (item.area() > maxArea)
+      continue;
+    candidates.push_back(item.id);
   }
 }
 
 }
 
-void PackerMove::sequenceInsert(vector<Item> &sequence, mt19937 &rgen, const vector<vector<Item> > &all, int subseqId, int totalArea) {
+void PackerMove::sequenceInsert(vector<int> &sequence, mt19937 &rgen, const vector<int> &offsets, int subseqId, int totalArea) {
   // Find the stacks in each sequence
   int maxArea = totalArea;
-  for (Item item : sequence)  maxArea -= item.area();
+  for (int id : sequence)  maxArea -= problem().items()[id].area();
 
   // TODO: prendre un item avant aussi bien qu'après
-  vector<Item> candidates;
-  findCandidatesBefore(candidates, all, subseqId, maxArea);
-  findCandidatesAfter(candidates, all, subseqId, maxArea);
+  vector<int> candidates;
+  findCandidatesBefore(candidates, problem(), view().sequence(), offsets[subseqId], maxArea);
+  findCandidatesAfter(candidates, problem(), view().sequence(), offsets[subseqId + 1], maxArea);
  
   if (candidates.empty()) return;
 
@@ -65,15 +61,15 @@ void PackerMove::sequenceInsert(vector<Item> &sequence, mt19937 &rgen, const vec
   repairSequence(sequence);
 }
 
-void PackerMove::sequenceShuffle(vector<Item> &sequence, mt19937 &rgen, const vector<vector<Item> > &all, int subseqId, int totalArea) {
+void PackerMove::sequenceShuffle(vector<int> &sequence, mt19937 &rgen, const vector<int> &offsets, int subseqId, int totalArea) {
   // Find the stacks in each sequence
   int maxArea = totalArea;
-  for (Item item : sequence)  maxArea -= item.area();
+  for (int id : sequence)  maxArea -= problem().items()[id].area();
 
   // TODO: prendre un item avant aussi bien qu'après
-  vector<Item> candidates;
-  findCandidatesBefore(candidates, all, subseqId, maxArea);
-  findCandidatesAfter(candidates, all, subseqId, maxArea);
+  vector<int> candidates;
+  findCandidatesBefore(candidates, problem(), view().sequence(), offsets[subseqId], maxArea);
+  findCandidatesAfter(candidates, problem(), view().sequence(), offsets[subseqId + 1], maxArea);
  
   if (candidates.empty()) return;
 
@@ -83,41 +79,38 @@ void PackerMove::sequenceShuffle(vector<Item> &sequence, mt19937 &rgen, const ve
   repairSequence(sequence);
 }
 
-vector<Item> PackerMove::recreateFullSequence(const vector<Item> &newSubseq, const vector<vector<Item> > &all, int id) {
-  set<int> seenIds;
-  for (Item item : newSubseq) seenIds.insert(item.id);
+vector<int> PackerMove::recreateFullSequence(const vector<int> &newSubseq, const vector<int> &offsets, int id) {
+  const vector<int> &sequence = view().sequence();
+  vector<char> seenIds(problem().items().size(), false);
+  for (int itemId : newSubseq) seenIds[itemId] = true;
 
-  vector<Item> ret;
-  for (int i = 0; i < id; ++i) {
-    for (Item item : all[i]) {
-      if (!seenIds.count(item.id))
-        ret.push_back(item);
-    }
+  vector<int> ret;
+  ret.reserve(problem().items().size());
+  for (int i = 0; i < offsets[id]; ++i) {
+    if (!seenIds[sequence[i]])
+      ret.push_back(sequence[i]);
   }
 
-  for (Item item : newSubseq) {
-    ret.push_back(item);
-  }
+  ret.insert(ret.end(), newSubseq.begin(), newSubseq.end());
 
-  for (int i = id + 1; i < (int) all.size(); ++i) {
-    for (Item item : all[i]) {
-      if (!seenIds.count(item.id))
-        ret.push_back(item);
-    }
+  for (int i = offsets[id + 1]; i < (int) sequence.size(); ++i) {
+    if (!seenIds[sequence[i]])
+      ret.push_back(sequence[i]);
   }
 
   return ret;
 }
 
-Solution PackerMove::runPackRow(Rectangle targetRow, const std::vector<Item> &sequence, const std::vector<std::vector<Item> > &allRows, int rowId) {
-  if (sequence.size() <= allRows[rowId].size()) {
+Solution PackerMove::runPackRow(Rectangle targetRow, const std::vector<int> &sequence, const std::vector<int> &rowOffsets, int rowId) {
+  if ((int) sequence.size() <= rowOffsets[rowId + 1] - rowOffsets[rowId]) {
     if (params().verbosity >= 4)
       cout << "No new item found fitting the given area" << endl;
     return Solution();
   }
 
-  RowPacker packer(sequence, params());
-  RowSolution newSol = packer.run(targetRow, 0, problem().plateDefects()[plateIdOfRow(rowId)]);
+  vector<Item> items = problem().itemSequence(sequence);
+  RowPacker packer(items, params());
+  RowSolution newSol = packer.run(targetRow, 0, problem().plateDefects()[view().plateOfRow(rowId)]);
 
   if (newSol.nItems() < (int) sequence.size()) {
     if (params().verbosity >= 4) {
@@ -130,21 +123,22 @@ Solution PackerMove::runPackRow(Rectangle targetRow, const std::vector<Item> &se
   }
 
   // Run the whole algorithm with the new sequence if an improvement was found
-  vector<Item> newSubseq = newSol.sequence(problem());
-  vector<Item> newSeq = recreateFullSequence(newSubseq, allRows, rowId);
+  vector<int> newSubseq = newSol.sequence();
+  vector<int> newSeq = recreateFullSequence(newSubseq, rowOffsets, rowId);
   checkSequenceValid(newSeq);
   return runSequence(newSeq);
 }
 
-Solution PackerMove::runPackCut(Rectangle targetCut, const std::vector<Item> &sequence, const std::vector<std::vector<Item> > &allCuts, int cutId) {
-  if (sequence.size() <= allCuts.size()) {
+Solution PackerMove::runPackCut(Rectangle targetCut, const std::vector<int> &sequence, const std::vector<int> &cutOffsets, int cutId) {
+  if ((int) sequence.size() <= view().nCuts()) {
     if (params().verbosity >= 4)
       cout << "No new item found fitting the given area" << endl;
     return Solution();
   }
 
-  CutPacker packer(sequence, params());
-  CutSolution newSol = packer.run(targetCut, 0, problem().plateDefects()[plateIdOfCut(cutId)]);
+  vector<Item> items = problem().itemSequence(sequence);
+  CutPacker packer(items, params());
+  CutSolution newSol = packer.run(targetCut, 0, problem().plateDefects()[view().plateOfCut(cutId)]);
 
   if (newSol.nItems() < (int) sequence.size()) {
     if (params().verbosity >= 4) {
@@ -157,20 +151,21 @@ Solution PackerMove::runPackCut(Rectangle targetCut, const std::vector<Item> &se
   }
 
   // Run the whole algorithm with the new sequence if an improvement was found
-  vector<Item> newSubseq = newSol.sequence(problem());
-  vector<Item> newSeq = recreateFullSequence(newSubseq, allCuts, cutId);
+  vector<int> newSubseq = newSol.sequence();
+  vector<int> newSeq = recreateFullSequence(newSubseq, cutOffsets, cutId);
   checkSequenceValid(newSeq);
   return runSequence(newSeq);
 }
 
-Solution PackerMove::runPackPlate(Rectangle targetPlate, const std::vector<Item> &sequence, const std::vector<std::vector<Item> > &allPlates, int plateId) {
-  if (sequence.size() <= allPlates.size()) {
+Solution PackerMove::runPackPlate(Rectangle targetPlate, const std::vector<int> &sequence, const std::vector<int> &plateOffsets, int plateId) {
+  if ((int) sequence.size() <= view().nPlates()) {
     if (params().verbosity >= 4)
       cout << "No new item found fitting the given area" << endl;
     return Solution();
   }
 
-  PlatePacker packer(problem(), sequence, params());
+  vector<Item> items = problem().itemSequence(sequence);
+  PlatePacker packer(problem(), items, params());
   PlateSolution newSol = packer.run(plateId, 0);
 
   if (newSol.nItems() < (int) sequence.size()) {
@@ -184,8 +179,8 @@ Solution PackerMove::runPackPlate(Rectangle targetPlate, const std::vector<Item>
   }
 
   // Run the whole algorithm with the new sequence if an improvement was found
-  vector<Item> newSubseq = newSol.sequence(problem());
-  vector<Item> newSeq = recreateFullSequence(newSubseq, allPlates, plateId);
+  vector<int> newSubseq = newSol.sequence();
+  vector<int> newSeq = recreateFullSequence(newSubseq, plateOffsets, plateId);
   checkSequenceValid(newSeq);
   return runSequence(newSeq);
 
@@ -193,85 +188,73 @@ Solution PackerMove::runPackPlate(Rectangle targetPlate, const std::vector<Item>
 
 Solution PackRowInsert::apply(mt19937& rgen) {
   // Select a random row to reoptimize
-  vector<RowSolution> rows = extractRows(solution());
-  if (rows.empty()) return Solution();
-  int rowId = uniform_int_distribution<int>(0, rows.size() - 1)(rgen);
-  RowSolution targetRow = rows[rowId];
+  if (view().nRows() == 0) return Solution();
+  int rowId = uniform_int_distribution<int>(0, view().nRows() - 1)(rgen);
+  const RowSolution &targetRow = view().row(rowId);
 
-  auto allRows = extractRowItems(solution());
-  vector<Item> sequence = rows[rowId].sequence(problem());
-  sequenceInsert(sequence, rgen, allRows, rowId, targetRow.area());
+  vector<int> sequence = targetRow.sequence();
+  sequenceInsert(sequence, rgen, view().rowOffsets(), rowId, targetRow.area());
 
-  return runPackRow(targetRow, sequence, allRows, rowId);
+  return runPackRow(targetRow, sequence, view().rowOffsets(), rowId);
 }
 
 Solution PackCutInsert::apply(mt19937& rgen) {
   // Select a random cut to reoptimize
-  vector<CutSolution> cuts = extractCuts(solution());
-  if (cuts.empty()) return Solution();
-  int cutId = uniform_int_distribution<int>(0, cuts.size() - 1)(rgen);
-  CutSolution targetCut = cuts[cutId];
+  if (view().nCuts() == 0) return Solution();
+  int cutId = uniform_int_distribution<int>(0, view().nCuts() - 1)(rgen);
+  const CutSolution &targetCut = view().cut(cutId);
 
-  auto allCuts = extractCutItems(solution());
-  vector<Item> sequence = cuts[cutId].sequence(problem());
-  sequenceInsert(sequence, rgen, allCuts, cutId, targetCut.area());
+  vector<int> sequence = targetCut.sequence();
+  sequenceInsert(sequence, rgen, view().cutOffsets(), cutId, targetCut.area());
 
-  return runPackCut(targetCut, sequence, allCuts, cutId);
+  return runPackCut(targetCut, sequence, view().cutOffsets(), cutId);
 }
 
 Solution PackPlateInsert::apply(mt19937& rgen) {
   // Select a random plate to reoptimize
-  vector<PlateSolution> plates = extractPlates(solution());
-  if (plates.empty()) return Solution();
-  int plateId = uniform_int_distribution<int>(0, plates.size() - 1)(rgen);
-  PlateSolution targetPlate = plates[plateId];
+  if (view().nPlates() == 0) return Solution();
+  int plateId = uniform_int_distribution<int>(0, view().nPlates() - 1)(rgen);
+  const PlateSolution &targetPlate = view().plate(plateId);
 
-  auto allPlates = extractPlateItems(solution());
-  vector<Item> sequence = plates[plateId].sequence(problem());
-  sequenceInsert(sequence, rgen, allPlates, plateId, targetPlate.area());
+  vector<int> sequence = targetPlate.sequence();
+  sequenceInsert(sequence, rgen, view().plateOffsets(), plateId, targetPlate.area());
 
-  return runPackPlate(targetPlate, sequence, allPlates, plateId);
+  return runPackPlate(targetPlate, sequence, view().plateOffsets(), plateId);
 }
 
 Solution PackRowShuffle::apply(mt19937& rgen) {
   // Select a random row to reoptimize
-  vector<RowSolution> rows = extractRows(solution());
-  if (rows.empty()) return Solution();
-  int rowId = uniform_int_distribution<int>(0, rows.size() - 1)(rgen);
-  RowSolution targetRow = rows[rowId];
+  if (view().nRows() == 0) return Solution();
+  int rowId = uniform_int_distribution<int>(0, view().nRows() - 1)(rgen);
+  const RowSolution &targetRow = view().row(rowId);
 
-  auto allRows = extractRowItems(solution());
-  vector<Item> sequence = rows[rowId].sequence(problem());
-  sequenceShuffle(sequence, rgen, allRows, rowId, targetRow.area());
+  vector<int> sequence = targetRow.sequence();
+  sequenceShuffle(sequence, rgen, view().rowOffsets(), rowId, targetRow.area());
 
-  return runPackRow(targetRow, sequence, allRows, rowId);
+  return runPackRow(targetRow, sequence, view().rowOffsets(), rowId);
 }
 
 Solution PackCutShuffle::apply(mt19937& rgen) {
   // Select a random cut to reoptimize
-  vector<CutSolution> cuts = extractCuts(solution());
-  if (cuts.empty()) return Solution();
-  int cutId = uniform_int_distribution<int>(0, cuts.size() - 1)(rgen);
-  CutSolution targetCut = cuts[cutId];
+  if (view().nCuts() == 0) return Solution();
+  int cutId = uniform_int_distribution<int>(0, view().nCuts() - 1)(rgen);
+  const CutSolution &targetCut = view().cut(cutId);
 
-  auto allCuts = extractCutItems(solution());
-  vector<Item> sequence = cuts[cutId].sequence(problem());
-  sequenceShuffle(sequence, rgen, allCuts, cutId, targetCut.area());
+  vector<int> sequence = targetCut.sequence();
+  sequenceShuffle(sequence, rgen, view().cutOffsets(), cutId, targetCut.area());
 
-  return runPackCut(targetCut, sequence, allCuts, cutId);
+  return runPackCut(targetCut, sequence, view().cutOffsets(), cutId);
 }
 
 Solution PackPlateShuffle::apply(mt19937& rgen) {
   // Select a random plate to reoptimize
-  vector<PlateSolution> plates = extractPlates(solution());
-  if (plates.empty()) return Solution();
-  int plateId = uniform_int_distribution<int>(0, plates.size() - 1)(rgen);
-  PlateSolution targetPlate = plates[plateId];
+  if (view().nPlates() == 0) return Solution();
+  int plateId = uniform_int_distribution<int>(0, view().nPlates() - 1)(rgen);
+  const PlateSolution &targetPlate = view().plate(plateId);
 
-  auto allPlates = extractPlateItems(solution());
-  vector<Item> sequence = plates[plateId].sequence(problem());
-  sequenceShuffle(sequence, rgen, allPlates, plateId, targetPlate.area());
+  vector<int> sequence = targetPlate.sequence();
+  sequenceShuffle(sequence, rgen, view().plateOffsets(), plateId, targetPlate.area());
 
-  return runPackPlate(targetPlate, sequence, allPlates, plateId);
+  return runPackPlate(targetPlate, sequence, view().plateOffsets(), plateId);
 }
 
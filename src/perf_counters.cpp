@@ -0,0 +1,184 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#include "perf_counters.hpp"
+
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <cstring>
+#include <cerrno>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+atomic<bool> PerfCounters::enabled_(false);
+
+namespace {
+const int nCounters = PerfCounters::nCounters;
+const int nKinds = PerfCounters::NKinds;
+const char *kindNames[nKinds] = {"RowPacker::count", "CutPacker::count", "PlatePacker::run", "SolutionChecker"};
+
+struct Totals {
+  uint64_t calls[nKinds];
+  uint64_t counts[nKinds][nCounters];
+
+  void add(const Totals &o) {
+    for (int k = 0; k < nKinds; ++k) {
+      calls[k] += o.calls[k];
+      for (int c = 0; c < nCounters; ++c) counts[k][c] += o.counts[k][c];
+    }
+  }
+};
+
+mutex totalsMutex;
+Totals totals = {};
+// Why the counters could not be opened; no thread tries again after a failure
+string failure;
+atomic<bool> unavailable(false);
+
+#ifdef __linux__
+int openCounter(uint64_t config, int groupFd) {
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP;
+  return syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0);
+}
+#endif
+
+struct ThreadCounters {
+  int fds[nCounters] = {-1, -1, -1, -1};
+  Totals local = {};
+
+  ~ThreadCounters() {
+    close();
+    lock_guard<mutex> lock(totalsMutex);
+    totals.add(local);
+  }
+
+  bool open() {
+    if (fds[0] >= 0) return true;
+    if (unavailable.load(memory_order_relaxed)) return false;
+#ifdef __linux__
+    const uint64_t configs[nCounters] = {
+      PERF_COUNT_HW_CPU_CYCLES,
+      PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_MISSES,
+      PERF_COUNT_HW_BRANCH_MISSES
+    };
+    for (int c = 0; c < nCounters; ++c) {
+      fds[c] = openCounter(configs[c], c == 0 ? -1 : fds[0]);
+      if (fds[c] < 0) {
+        fail(string("perf_event_open failed: ") + strerror(errno));
+        return false;
+      }
+    }
+    return true;
+#else
+    fail("perf_event_open is only available on Linux");
+    return false;
+#endif
+  }
+
+  bool read(uint64_t *values) {
+    if (!open()) return false;
+#ifdef __linux__
+    struct {
+      uint64_t nr;
+      uint64_t values[nCounters];
+    } data;
+    if (::read(fds[0], &data, sizeof(data)) != (ssize_t) sizeof(data)) {
+      fail(string("reading the counters failed: ") + strerror(errno));
+      return false;
+    }
+    memcpy(values, data.values, sizeof(data.values));
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  void fail(const string &reason) {
+    close();
+    lock_guard<mutex> lock(totalsMutex);
+    if (failure.empty()) failure = reason;
+    unavailable.store(true, memory_order_relaxed);
+  }
+
+  void close() {
+#ifdef __linux__
+    for (int c = nCounters - 1; c >= 0; --c) {
+      if (fds[c] >= 0) ::close(fds[c]);
+      fds[c] = -1;
+    }
+#endif
+  }
+};
+
+thread_local ThreadCounters threadCounters;
+}
+
+void PerfCounters::enable() {
+  enabled_.store(true, memory_order_relaxed);
+}
+
+bool PerfCounters::read(uint64_t *values) {
+  return threadCounters.read(values);
+}
+
+void PerfCounters::add(Kind kind, const uint64_t *begin) {
+  uint64_t end[nCounters];
+  if (!threadCounters.read(end)) return;
+  Totals &local = threadCounters.local;
+  ++local.calls[kind];
+  for (int c = 0; c < nCounters; ++c) {
+    local.counts[kind][c] += end[c] - begin[c];
+  }
+}
+
+void PerfCounters::report() {
+  Totals all;
+  string reason;
+  {
+    lock_guard<mutex> lock(totalsMutex);
+    all = totals;
+    reason = failure;
+  }
+  all.add(threadCounters.local);
+
+  cout << endl;
+  if (!reason.empty())
+    cout << "Hardware counters unavailable: " << reason << endl;
+  cout << "Kernel          \tCalls\tMcycles\tMinstr\tIPC\tCacheMPKI\tBranchMPKI" << endl;
+  for (int k = 0; k < nKinds; ++k) {
+    const uint64_t *counts = all.counts[k];
+    double instructions = counts[1];
+    string name = kindNames[k];
+    while (name.size() < 16)
+      name.append(" ");
+    cout << name;
+    cout << "\t" << all.calls[k];
+    cout << "\t" << 1.0e-6 * counts[0];
+    cout << "\t" << 1.0e-6 * counts[1];
+    if (counts[0] != 0 && counts[1] != 0) {
+      cout << "\t" << instructions / counts[0];
+      cout << "\t" << 1000.0 * counts[2] / instructions;
+      cout << "\t\t" << 1000.0 * counts[3] / instructions;
+    }
+    else {
+      cout << "\t-\t-\t\t-";
+    }
+    cout << endl;
+  }
+  cout << endl;
+}
+
@@ -2,6 +2,8 @@
 
 #include "plate_packer.hpp"
 #include "utils.hpp"
+#include "tracer.hpp"
+#include "perf_counters.hpp"
 
 #include <cassert>
 #include <algorithm>
@@ -24,14 +26,20 @@ PlateSolution PlatePacker::runExact() {
   // Fill the front
   vector<int> front(Params::widthPlates + 1, -1);
   vector<int> prev(Params::widthPlates + 1, -1);
+  // The cuts from a given coordinate often have the same count for a range of widths
+  vector<CutPacker::CutWidthRange> cuts(Params::widthPlates + 1);
   front[0] = start_;
   for (int j = Params::minXX; j <= Params::widthPlates; ++j) {
     int best = -1;
     int pred = -1;
+    if (cancelled()) return PlateSolution();
     if (!isAdmissibleCutLine(j)) continue;
     for (int i = max(0, j - Params::maxXX); i <= j - Params::minXX; ++i) {
       if (front[i] < 0) continue;
-      int cnt = front[i] + countCut(front[i], i, j).nItems;
+      CutPacker::CutWidthRange &cut = cuts[i];
+      if (j < cut.minMaxX || j > cut.maxMaxX)
+        cut = countCutWidthRange(front[i], i, j);
+      int cnt = front[i] + cut.description.nItems;
       if (cnt > best) {
         best = cnt;
         pred = i;
@@ -66,13 +74,13 @@ PlateSolution PlatePacker::runExact() {
 }
 
 PlateSolution PlatePacker::runApproximate() {
-  // Fill the front
-  front_.clear();
-  front_.init(region_.minX(), start_);
-  for (int i = 0; i < front_.size(); ++i) {
-    propagate(i, front_[i].end);
-    propagateBreakpoints(i);
-  }
+  // Dispatch once per plate, so that the propagation without defects skips all defect checks
+  if (nDefects() == 0)
+    fillFront<false>();
+  else
+    fillFront<true>();
+  // The front is incomplete: the caller is expected to discard the plate
+  if (cancelled()) return PlateSolution();
   front_.checkConsistency();
 
   // Build the slices
@@ -116,9 +124,22 @@ PlateSolution PlatePacker::runApproximate() {
   return backtrack();
 }
 
+template<bool HasDefects>
+void PlatePacker::fillFront() {
+  front_.clear();
+  front_.init(region_.minX(), start_);
+  for (int i = 0; i < front_.size(); ++i) {
+    propagate<HasDefects>(i, front_[i].end);
+    if (HasDefects)
+      propagateBreakpoints(i);
+    if (cancelled()) return;
+  }
+}
+
 PlateSolution PlatePacker::runDiagnostic() {
   PlateSolution approximate = runApproximate();
   PlateSolution exact = runExact();
+  if (cancelled()) return exact;
   if (approximate.nItems() != exact.nItems()) {
     cout << "Exact plate algorithm obtains " << exact.nItems() << " items but approximate one obtains " << approximate.nItems() << endl;
     cout << "Exact" << endl;
@@ -158,6 +179,8 @@ void PlatePacker::setup(int plateId, int start) {
 }
 
 PlateSolution PlatePacker::run(int plateId, int start) {
+  Tracer::Span span("PlatePacker::run", "packer");
+  PerfCounters::Scope scope(PerfCounters::PlateRun);
   setup(plateId, start);
   if (options_.platePacking == PackingOption::Approximate) {
     return runApproximate();
@@ -175,30 +198,37 @@ CutPacker::CutDescription PlatePacker::countCut(int start, int minX, int maxX) {
   return cutPacker_.count(cut, start, defects_);
 }
 
+CutPacker::CutWidthRange PlatePacker::countCutWidthRange(int start, int minX, int maxX) {
+  Rectangle cut = Rectangle::FromCoordinates(minX, region_.minY(), maxX, region_.maxY());
+  return cutPacker_.countWidthRange(cut, start, defects_);
+}
+
 CutSolution PlatePacker::packCut(int start, int minX, int maxX) {
   Rectangle cut = Rectangle::FromCoordinates(minX, region_.minY(), maxX, region_.maxY());
   return cutPacker_.run(cut, start, defects_);
 }
 
+template<bool HasDefects>
 void PlatePacker::propagate(int previousFront, int beginCoord) {
   int previousItems = front_[previousFront].value;
   int maxEndCoord = min(region_.maxX(), beginCoord + Params::maxXX);
   for (int endCoord = maxEndCoord + Params::minWaste; endCoord >= beginCoord + Params::minXX; --endCoord) {
-    if (!isAdmissibleCutLine(endCoord)) continue;
+    if (cancelled()) return;
+    if (!isAdmissibleCutLine<HasDefects>(endCoord)) continue;
     CutPacker::CutDescription result = countCut(previousItems, beginCoord, endCoord);
     if (result.nItems == 0) break;
     int coord = utils::extendToFit(result.maxUsedX, region_.maxX(), Params::minWaste);
-    bool valid = coord == result.maxUsedX || isAdmissibleCutLine(coord);
+    bool valid = coord == result.maxUsedX || isAdmissibleCutLine<HasDefects>(coord);
     if (coord <= maxEndCoord && valid && utils::fitsMinWaste(result.maxUsedX, result.tightX, region_.maxX())) {
       insertInFront(beginCoord, coord, previousItems + result.nItems, previousFront);
     }
     // One more attempt, but tight this time
     if (!result.tightX
-     && isAdmissibleCutLine(result.maxUsedX - Params::minWaste)
+     && isAdmissibleCutLine<HasDefects>(result.maxUsedX - Params::minWaste)
      && result.maxUsedX - Params::minWaste >= beginCoord + Params::minXX) {
       CutPacker::CutDescription tight = countCut(previousItems, beginCoord, result.maxUsedX - Params::minWaste);
       int coord = utils::extendToFit(tight.maxUsedX, region_.maxX(), Params::minWaste);
-      bool valid = coord == tight.maxUsedX || isAdmissibleCutLine(coord);
+      bool valid = coord == tight.maxUsedX || isAdmissibleCutLine<HasDefects>(coord);
       if (coord <= maxEndCoord && valid && utils::fitsMinWaste(tight.maxUsedX, tight.tightX, region_.maxX())) {
         insertInFront(beginCoord, coord, previousItems + tight.nItems, previousFront);
       }
@@ -238,11 +268,11 @@ void PlatePacker::propagateBreakpoints(int after) {
     for (int i = 1; i <= after; ++i) {
       int cutPos = front_[i].end + Params::minWaste;
       if (cutPos > bp && isAdmissibleCutLine(cutPos) && cutPos <= front_[i].begin + Params::maxXX)
-        propagate(i, cutPos);
+        propagate<true>(i, cutPos);
     }
     int firstCutPos = region_.minX() + Params::minXX;
     if (bp < firstCutPos && isAdmissibleCutLine(firstCutPos)) {
-      propagate(0, firstCutPos);
+      propagate<true>(0, firstCutPos);
     }
     int maxValid = 0;
     for (int i = 1; i <= after; ++i) {
@@ -251,7 +281,7 @@ void PlatePacker::propagateBreakpoints(int after) {
         maxValid = i;
     }
     if (isAdmissibleCutLine(bp)) {
-      propagate(maxValid, bp);
+      propagate<true>(maxValid, bp);
     }
   }
 }
@@ -274,11 +304,14 @@ PlateSolution PlatePacker::backtrack() {
   return plateSolution;
 }
 
+template<bool HasDefects>
 bool PlatePacker::isAdmissibleCutLine(int x) const {
   if (x == 0 || x == Params::widthPlates)
     return true;
   if (x < Params::minXX || x > Params::widthPlates - Params::minWaste)
     return false;
+  if (!HasDefects)
+    return true;
   for (Defect d : defects_) {
     if (d.intersectsVerticalLine(x))
       return false;
@@ -9,12 +9,18 @@
 
 using namespace std;
 
-Problem::Problem(vector<Item> items, vector<Defect> defects)
+Problem::Problem(vector<Item> items, vector<Defect> defects, int nPlates)
 : items_(items)
 , defects_(defects)
 {
+  // Items are always stored with their smallest dimension as width
+  for (Item &item : items_) {
+    if (item.width > item.height)
+      swap(item.width, item.height);
+  }
   buildSequences();
-  buildPlates();
+  buildClasses();
+  buildPlates(nPlates);
   checkConsistency();
 }
 
@@ -31,15 +37,36 @@ void Problem::buildSequences() {
   }
 }
 
-void Problem::buildPlates() {
-  plateDefects_.resize(Params::nPlates);
+void Problem::buildClasses() {
+  map<pair<int, int>, int> dimensionToClass;
+  for (Item item : items_) {
+    auto it = dimensionToClass.emplace(make_pair(item.width, item.height), dimensionToClass.size()).first;
+    itemClasses_.push_back(it->second);
+  }
+  nItemClasses_ = dimensionToClass.size();
+}
+
+void Problem::buildPlates(int nPlates) {
   for (Defect d : defects_) {
-    if (d.plateId < 0 || d.plateId >= Params::nPlates)
+    nPlates = max(nPlates, d.plateId + 1);
+  }
+  plateDefects_.resize(nPlates);
+  for (Defect d : defects_) {
+    if (d.plateId < 0)
       continue;
     plateDefects_[d.plateId].push_back(d);
   }
 }
 
+vector<Item> Problem::itemSequence(const vector<int> &ids) const {
+  vector<Item> sequence;
+  sequence.reserve(ids.size());
+  for (int id : ids) {
+    sequence.push_back(items_[id]);
+  }
+  return sequence;
+}
+
 void Problem::checkConsistency() const {
   for (int i = 0; i < (int) items_.size(); ++i) {
     Item item = items_[i];
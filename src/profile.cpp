@@ -0,0 +1,58 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#include "profile.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+using namespace std;
+
+Profile::Profile()
+: startTime_(chrono::steady_clock::now())
+, startClock_(clock()) {
+}
+
+void Profile::add(uint64_t nMoves, double mapped, double density, const string &move) {
+  ProfilePoint point;
+  point.wallTime = chrono::duration<double>(chrono::steady_clock::now() - startTime_).count();
+  point.cpuTime = (double) (clock() - startClock_) / CLOCKS_PER_SEC;
+  point.nMoves = nMoves;
+  point.mapped = mapped;
+  point.density = density;
+  point.move = move;
+  points_.push_back(point);
+}
+
+void Profile::write(const string &fileName, double timeLimit) const {
+  ofstream f(fileName);
+  if (f.fail())
+    throw runtime_error("Couldn't open file \"" + fileName + "\".");
+  f << fixed << setprecision(4);
+  string extension = ".json";
+  if (fileName.size() >= extension.size()
+   && fileName.compare(fileName.size() - extension.size(), extension.size(), extension) == 0)
+    writeJson(f, timeLimit);
+  else
+    writeCsv(f, timeLimit);
+}
+
+void Profile::writeCsv(ostream &s, double timeLimit) const {
+  s << "wall_time,cpu_time,moves,mapped,density,move,time_limit" << endl;
+  for (const ProfilePoint &p : points_) {
+    s << p.wallTime << "," << p.cpuTime << "," << p.nMoves << ",";
+    s << p.mapped << "," << p.density << "," << p.move << "," << timeLimit << endl;
+  }
+}
+
+void Profile::writeJson(ostream &s, double timeLimit) const {
+  s << "{\"time_limit\":" << timeLimit << ",\"points\":[" << endl;
+  for (size_t i = 0; i < points_.size(); ++i) {
+    const ProfilePoint &p = points_[i];
+    s << "{\"wall_time\":" << p.wallTime << ",\"cpu_time\":" << p.cpuTime << ",\"moves\":" << p.nMoves;
+    s << ",\"mapped\":" << p.mapped << ",\"density\":" << p.density << ",\"move\":\"" << p.move << "\"}";
+    if (i + 1 < points_.size()) s << ",";
+    s << endl;
+  }
+  s << "]}" << endl;
+}
@@ -2,6 +2,7 @@
 
 #include "row_packer.hpp"
 #include "utils.hpp"
+#include "perf_counters.hpp"
 
 #include <cassert>
 #include <algorithm>
@@ -29,11 +30,10 @@ RowSolution RowPacker::run(Rectangle row, int start, const vector<Defect> &defec
 }
 
 RowPacker::RowDescription RowPacker::count(Rectangle row, int start, const vector<Defect> &defects) {
+  PerfCounters::Scope scope(PerfCounters::RowCount);
   init(row, start, defects);
   checkConsistency();
-  if (options_.rowPacking != PackingOption::Approximate
-   && options_.cutPacking != PackingOption::Approximate
-   && options_.platePacking != PackingOption::Approximate) {
+  if (!countIsApproximate()) {
     // Since maxUsedX/maxUsedY are not properly computed, only allowed whenever everything is exact
     RowSolution solution = runExact();
     RowDescription desc;
@@ -47,6 +47,175 @@ RowPacker::RowDescription RowPacker::count(Rectangle row, int start, const vecto
   }
 }
 
+bool RowPacker::countIsApproximate() const {
+  return options_.rowPacking == PackingOption::Approximate
+      || options_.cutPacking == PackingOption::Approximate
+      || options_.platePacking == PackingOption::Approximate;
+}
+
+namespace {
+// A range of row heights where the greedy packing has taken the same decisions so far
+struct ProfileBranch {
+  int minHeight;
+  int maxHeight;
+  int left;
+  int nItems;
+  int maxItemHeight;
+  int secondItemHeight;
+};
+
+enum class ProfileDecision {
+  Stop,
+  Place,
+  PlaceRotated
+};
+}
+
+void RowPacker::countProfile(Rectangle row, int start, vector<RowProfileStep> &profile) {
+  // Same decisions as countNoDefectsSimple for every height at once: a branch is split whenever an item fits in part of its height range only
+  init(row, start, vector<Defect>());
+  checkConsistency();
+  assert (countIsApproximate());
+  profile.clear();
+
+  vector<ProfileBranch> branches;
+  vector<ProfileBranch> nextBranches;
+  branches.push_back(ProfileBranch{1, region_.height(), region_.width(), 0, 0, -Params::minWaste});
+
+  auto emit = [&](const ProfileBranch &branch) {
+    RowProfileStep step;
+    step.minMaxY = region_.minY() + branch.minHeight - 1;
+    step.maxMaxY = region_.minY() + branch.maxHeight;
+    step.description.nItems = branch.nItems;
+    fillXData(step.description, region_.maxX() - branch.left);
+    bool tightY = branch.secondItemHeight + Params::minWaste <= branch.maxItemHeight;
+    fillYData(step.description, branch.maxItemHeight, tightY);
+    profile.push_back(step);
+  };
+
+  for (int i = start_; i < nItems() && !branches.empty(); ++i) {
+    Item item = sequence_[i];
+    // Heights where fitsMinWaste(item.height, h) or fitsMinWaste(item.width, h) may change
+    int bounds[] = {
+      item.height, item.height + 1, item.height + Params::minWaste,
+      item.width, item.width + 1, item.width + Params::minWaste
+    };
+    sort(begin(bounds), end(bounds));
+    nextBranches.clear();
+    for (const ProfileBranch &branch : branches) {
+      // Split the branch into height ranges where the item is placed the same way
+      ProfileBranch current = branch;
+      ProfileDecision currentDecision = ProfileDecision::Stop;
+      for (int b = -1; b < 6; ++b) {
+        if (b >= 0 && (bounds[b] <= branch.minHeight || bounds[b] > branch.maxHeight)) continue;
+        if (b > 0 && bounds[b] == bounds[b-1]) continue;
+        int lo = b < 0 ? branch.minHeight : bounds[b];
+        ProfileDecision decision = ProfileDecision::Stop;
+        if (utils::fitsMinWaste(item.height, lo) && utils::fitsMinWaste(item.width, branch.left))
+          decision = ProfileDecision::Place;
+        else if (utils::fitsMinWaste(item.width, lo) && utils::fitsMinWaste(item.height, branch.left))
+          decision = ProfileDecision::PlaceRotated;
+        if (b >= 0) {
+          if (decision == currentDecision) continue;
+          current.maxHeight = lo - 1;
+          if (currentDecision == ProfileDecision::Stop) emit(current);
+          else nextBranches.push_back(current);
+        }
+        current = branch;
+        current.minHeight = lo;
+        currentDecision = decision;
+        if (decision != ProfileDecision::Stop) {
+          int height = decision == ProfileDecision::Place ? item.height : item.width;
+          current.left -= decision == ProfileDecision::Place ? item.width : item.height;
+          if (current.nItems == 0) {
+            current.maxItemHeight = height;
+          }
+          else if (height > current.maxItemHeight) {
+            current.secondItemHeight = current.maxItemHeight;
+            current.maxItemHeight = height;
+          }
+          else if (height < current.maxItemHeight) {
+            current.secondItemHeight = max(current.secondItemHeight, height);
+          }
+          ++current.nItems;
+        }
+      }
+      current.maxHeight = branch.maxHeight;
+      if (currentDecision == ProfileDecision::Stop) emit(current);
+      else nextBranches.push_back(current);
+    }
+    branches.swap(nextBranches);
+  }
+  for (const ProfileBranch &branch : branches) {
+    emit(branch);
+  }
+
+  sort(profile.begin(), profile.end(),
+      [](const RowProfileStep &a, const RowProfileStep &b) {
+        return a.maxMaxY < b.maxMaxY;
+      });
+}
+
+namespace {
+// Restrict the range to the widths where fitsMinWaste(a, left) is unchanged, left following the width
+void restrictFitRange(int a, int left, int width, int &minWidth, int &maxWidth) {
+  if (left == a) {
+    minWidth = max(minWidth, width);
+    maxWidth = min(maxWidth, width);
+  }
+  else if (left >= a + Params::minWaste) {
+    minWidth = max(minWidth, width - (left - a - Params::minWaste));
+  }
+  else if (left < a) {
+    maxWidth = min(maxWidth, width + (a - 1 - left));
+  }
+  else {
+    minWidth = max(minWidth, width - (left - a - 1));
+    maxWidth = min(maxWidth, width + (a + Params::minWaste - 1 - left));
+  }
+}
+}
+
+RowPacker::RowWidthRange RowPacker::countWidthRange(Rectangle row, int start) {
+  // Same decisions as countNoDefectsSimple, keeping track of the widths where they stay the same
+  init(row, start, vector<Defect>());
+  checkConsistency();
+  assert (countIsApproximate());
+  const int width = region_.width();
+  const int height = region_.height();
+  int left = width;
+  RowWidthRange range;
+  range.minWidth = Params::minXX;
+  range.maxWidth = Params::widthPlates;
+  for (int i = start_; i < nItems(); ++i) {
+    Item item = sequence_[i];
+    bool fits = false;
+    if (utils::fitsMinWaste(item.height, height)) {
+      restrictFitRange(item.width, left, width, range.minWidth, range.maxWidth);
+      if (utils::fitsMinWaste(item.width, left)) {
+        left -= item.width;
+        heights_[i] = item.height;
+        fits = true;
+      }
+    }
+    if (!fits && utils::fitsMinWaste(item.width, height)) {
+      restrictFitRange(item.height, left, width, range.minWidth, range.maxWidth);
+      if (utils::fitsMinWaste(item.height, left)) {
+        left -= item.height;
+        heights_[i] = item.width;
+        fits = true;
+      }
+    }
+    if (!fits)
+      break;
+    ++range.description.nItems;
+  }
+  fillXData(range.description, region_.maxX() - left);
+  fillYData(range.description);
+  range.description.maxUsedX -= region_.minX();
+  return range;
+}
+
 RowPacker::RowDescription RowPacker::countNoDefectsSimple() {
   const int width = region_.width();
   const int height = region_.height();
@@ -299,14 +468,19 @@ void RowPacker::fillYData(RowDescription &description) const {
     maxHeight = max(heights_[i], maxHeight);
     assert (utils::fitsMinWaste(heights_[i], region_.height()));
   }
-  description.maxUsedY = region_.minY() + maxHeight;
-  description.tightY = true;
+  bool tightY = true;
   for (int i = start_; i < start_ + description.nItems; ++i) {
     if (heights_[i] == maxHeight)
       continue;
     if (heights_[i] + Params::minWaste > maxHeight)
-      description.tightY = false;
+      tightY = false;
   }
+  fillYData(description, maxHeight, tightY);
+}
+
+void RowPacker::fillYData(RowDescription &description, int maxHeight, bool tightY) const {
+  description.maxUsedY = region_.minY() + maxHeight;
+  description.tightY = tightY;
   if (!description.tightY) description.maxUsedY += Params::minWaste;
   int firstCut = firstValidHorizontalCut(description.maxUsedY, description.tightY);
   if (firstCut != description.maxUsedY) {
@@ -2,9 +2,12 @@
 
 #include "sequence_packer.hpp"
 #include "plate_packer.hpp"
+#include "cancellation.hpp"
+#include "tracer.hpp"
 
 #include <cassert>
 #include <algorithm>
+#include <future>
 
 /*
  * Dynamic programming on all cutting points
@@ -13,62 +16,74 @@
 using namespace std;
 
 Solution SequencePacker::run(const Problem &problem, const vector<Item> &sequence, SolverParams options, const Solution &existing) {
-  SequencePacker packer(problem, sequence, options, existing);
+  int beginDiff, endDiff;
+  diffBounds(sequence, existing, beginDiff, endDiff);
+  return run(problem, sequence, options, existing, beginDiff, endDiff);
+}
+
+Solution SequencePacker::run(const Problem &problem, const vector<Item> &sequence, SolverParams options, const Solution &existing, int beginDiff, int endDiff) {
+  Tracer::Span span("SequencePacker::run", "packer");
+  SequencePacker packer(problem, sequence, options, existing, beginDiff, endDiff);
   packer.run();
   return packer.solution_;
 }
 
-SequencePacker::SequencePacker(const Problem &problem, const vector<Item> &sequence, SolverParams options, const Solution &existing)
+SequencePacker::SequencePacker(const Problem &problem, const vector<Item> &sequence, SolverParams options, const Solution &existing, int beginDiff, int endDiff)
 : problem_(problem)
 , existingSolution_(existing)
 , sequence_(sequence)
-, options_(options) {
+, options_(options)
+, beginDiff_(beginDiff)
+, endDiff_(endDiff) {
   packedItems_ = 0;
   packedExistingItems_ = 0;
+  guessedPlate_ = -1;
+  guessedStart_ = -1;
 }
 
-int SequencePacker::sequenceBeginDiff() const {
-  vector<Item> existingSeq = existingSolution_.sequence(problem_);
-  int beginDiff = 0;
-  for (beginDiff = 0; beginDiff < (int) sequence_.size(); ++beginDiff) {
-    int ind = beginDiff;
-    if (ind < (int) existingSeq.size()
-     && existingSeq[ind].id != sequence_[ind].id) break;
-  }
-  return beginDiff;
-}
-
-int SequencePacker::sequenceEndDiff() const {
-  vector<Item> existingSeq = existingSolution_.sequence(problem_);
-  int endDiff = sequence_.size();
-  for (; endDiff > 0; --endDiff) {
-    int ind = endDiff - 1;
-    if (ind < (int) existingSeq.size()
-     && existingSeq[ind].id != sequence_[ind].id) break;
+void SequencePacker::diffBounds(const vector<Item> &sequence, const Solution &existing, int &beginDiff, int &endDiff) {
+  // First and last positions where the items differ; the whole sequence if none do
+  int n = sequence.size();
+  int firstDiff = n;
+  int lastDiff = -1;
+  int ind = 0;
+  for (const PlateSolution &plate : existing.plates) {
+    for (const CutSolution &cut : plate.cuts) {
+      for (const RowSolution &row : cut.rows) {
+        for (const ItemSolution &item : row.items) {
+          if (ind < n && item.itemId != sequence[ind].id) {
+            firstDiff = min(firstDiff, ind);
+            lastDiff = ind;
+          }
+          ++ind;
+        }
+      }
+    }
   }
-  if (endDiff == 0) endDiff = sequence_.size();
-  return endDiff;
+  beginDiff = firstDiff;
+  endDiff = lastDiff >= 0 ? lastDiff + 1 : n;
 }
 
 void SequencePacker::runNoCancel() {
-  while (solution_.nPlates() < Params::nPlates) {
+  while (solution_.nPlates() < problem_.nPlates()) {
     if (packedItems_ == (int) sequence_.size()) break;
-    PlateSolution plate = PlatePacker::run(problem_, sequence_, options_, solution_.nPlates(), packedItems_);
+    PlateSolution plate = packPlate();
+    if (cancelled()) {
+      solution_ = Solution();
+      break;
+    }
     packedItems_ += plate.nItems();
-    solution_.plates.push_back(plate);
+    solution_.plates.push_back(move(plate));
   }
 }
 
 void SequencePacker::runEarlyCancel() {
-  int beginDiff = sequenceBeginDiff();
-  int endDiff = sequenceEndDiff();
-
-  while (solution_.nPlates() < Params::nPlates) {
+  while (solution_.nPlates() < problem_.nPlates()) {
     if (packedItems_ == (int) sequence_.size()) {
       break;
     }
 
-    if (packedExistingItems_ > endDiff) {
+    if (packedExistingItems_ > endDiff_) {
       // Worse solution: early break
       if (packedExistingItems_ > packedItems_) {
         solution_ = Solution();
@@ -84,25 +99,101 @@ void SequencePacker::runEarlyCancel() {
       // Good: let's go on
     }
 
-    PlateSolution existingPlate;
-    if (solution_.nPlates() < existingSolution_.nPlates())
-      existingPlate = existingSolution_.plates[solution_.nPlates()];
-    packedExistingItems_ += existingPlate.nItems();
+    bool existingPlate = solution_.nPlates() < existingSolution_.nPlates();
+    if (existingPlate)
+      packedExistingItems_ += existingSolution_.plates[solution_.nPlates()]->nItems();
 
-    PlateSolution plate;
-    if (solution_.nPlates() < existingSolution_.nPlates() && packedExistingItems_ < beginDiff) {
-      // Reuse the beginning of the previous solution
+    if (existingPlate && packedExistingItems_ < beginDiff_) {
+      // Reuse the beginning of the previous solution; the plate is shared, not copied
       // Strict to allow one more item to be inserted
-      plate = existingPlate;
+      solution_.plates.push_back(existingSolution_.plates[solution_.nPlates()]);
     }
     else {
-      plate = PlatePacker::run(problem_, sequence_, options_, solution_.nPlates(), packedItems_);
+      PlateSolution plate = packPlate();
+      if (cancelled()) {
+        solution_ = Solution();
+        break;
+      }
+      solution_.plates.push_back(move(plate));
     }
-    packedItems_ += plate.nItems();
-    solution_.plates.push_back(plate);
+    packedItems_ += solution_.plates.back()->nItems();
   }
 }
 
+PlateSolution SequencePacker::packPlate() {
+  int plateId = solution_.nPlates();
+  if (options_.speculativeThreads == 0)
+    return PlatePacker::run(problem_, sequence_, options_, plateId, packedItems_);
+
+  // While a plate is packed, other threads pack the next one from its most likely starts
+  vector<pair<int, future<PlateSolution> > > next;
+  if (plateId + 1 < problem_.nPlates()) {
+    for (int start : guessPlateEnds()) {
+      next.emplace_back(start, async(launch::async, [this, plateId, start]() {
+        return PlatePacker::run(problem_, sequence_, options_, plateId + 1, start);
+      }));
+    }
+  }
+
+  PlateSolution plate;
+  if (guessed_.valid() && guessedPlate_ == plateId && guessedStart_ == packedItems_)
+    plate = guessed_.get();
+  else
+    plate = PlatePacker::run(problem_, sequence_, options_, plateId, packedItems_);
+  guessed_ = future<PlateSolution>();
+
+  // Keep the packing of the next plate if its start was guessed; the others are waited for and dropped
+  int end = packedItems_ + plate.nItems();
+  for (auto &guess : next) {
+    if (guess.first == end) {
+      guessed_ = move(guess.second);
+      guessedPlate_ = plateId + 1;
+      guessedStart_ = end;
+    }
+  }
+  return plate;
+}
+
+vector<int> SequencePacker::guessPlateEnds() const {
+  // Same item area as the existing solution's plate, or else as the previous plate
+  int plateId = solution_.nPlates();
+  const PlateSolution *reference;
+  if (plateId < existingSolution_.nPlates())
+    reference = &*existingSolution_.plates[plateId];
+  else if (plateId > 0)
+    reference = &*solution_.plates.back();
+  else
+    return vector<int>();
+
+  long long targetArea = 0;
+  for (const CutSolution &cut : reference->cuts) {
+    for (const RowSolution &row : cut.rows) {
+      for (const ItemSolution &item : row.items) {
+        targetArea += item.area();
+      }
+    }
+  }
+  int expected = packedItems_;
+  long long area = 0;
+  while (expected < (int) sequence_.size() && area + sequence_[expected].area() / 2 <= targetArea) {
+    area += sequence_[expected].area();
+    ++expected;
+  }
+
+  vector<int> ends;
+  for (int i = 0; (int) ends.size() < (int) options_.speculativeThreads && i <= 2 * (int) options_.speculativeThreads; ++i) {
+    int offset = i % 2 == 0 ? i / 2 : -(i + 1) / 2;
+    int end = expected + offset;
+    if (end > packedItems_ && end < (int) sequence_.size())
+      ends.push_back(end);
+  }
+  return ends;
+}
+
+bool SequencePacker::cancelled() const {
+  return options_.deadline != nullptr && options_.deadline->expired();
+}
+
 void SequencePacker::run() {
   if (options_.earlyCancel)
     runEarlyCancel();
@@ -257,7 +257,11 @@ int SolutionWriter::writeRectangle(Rectangle r, int type, int cutLevel, int pare
 
 void Solution::write(string name) const {
   ofstream solutionFile(name);
-  SolutionWriter::run(*this, solutionFile);
+  write(solutionFile);
+}
+
+void Solution::write(ostream &s) const {
+  SolutionWriter::run(*this, s);
 }
 
 class SolutionReader {
@@ -3,6 +3,8 @@
 #include "solution_checker.hpp"
 #include "problem.hpp"
 #include "solution.hpp"
+#include "lower_bound.hpp"
+#include "perf_counters.hpp"
 #include "utils.hpp"
 
 #include <unordered_set>
@@ -59,17 +61,20 @@ void SolutionChecker::report(const Problem &problem, const Solution &solution) {
 }
 
 int SolutionChecker::nViolations(const Problem &problem, const Solution &solution) {
+  PerfCounters::Scope scope(PerfCounters::Checker);
   SolutionChecker checker(problem);
   checker.checkSolution(solution);
   return checker.nViolations();
 }
 
 double SolutionChecker::evalPercentMapped(const Problem &problem, const Solution &solution) {
+  PerfCounters::Scope scope(PerfCounters::Checker);
   SolutionChecker checker(problem);
   return 100.0 * checker.evalAreaMapped(solution) / checker.evalTotalArea();
 }
 
 double SolutionChecker::evalPercentDensity(const Problem &problem, const Solution &solution) {
+  PerfCounters::Scope scope(PerfCounters::Checker);
   SolutionChecker checker(problem);
   return 100.0 * checker.evalAreaMapped(solution) / checker.evalAreaUsage(solution);
 }
@@ -89,7 +94,7 @@ void SolutionChecker::checkSolution(const Solution &solution) {
   checkItemUnicity(solution);
   checkSequences(solution);
 
-  if (Params::nPlates < (int) solution.plates.size())
+  if (problem_.nPlates() < (int) solution.plates.size())
     error("Critical", "Too many plates in the solution");
 
   for (int i = 0; i < (int) solution.plates.size(); ++i) {
@@ -425,14 +430,14 @@ void SolutionChecker::reportProblem() {
   cout << nItems() << " items to cut" << endl;
   cout << problem_.stackItems().size() << " stacks" << endl;
   int maxDim = 0;
-  for (Item item : problem_.items()) maxDim = max(maxDim, item.height);
+  for (Item item : problem_.items()) maxDim = max(maxDim, (int) item.height);
   cout << maxDim << " maximum size" << endl;
   int minDim = maxDim;
-  for (Item item : problem_.items()) minDim = min(minDim, item.width);
+  for (Item item : problem_.items()) minDim = min(minDim, (int) item.width);
   cout << minDim << " minimum size" << endl;
-  long long total = evalTotalArea();
+  long long bound = LowerBound::areaUsage(problem_);
   long long plate = evalPlateArea();
-  cout << 1.0 * total / plate << " plates minimum" << endl;
+  cout << 1.0 * bound / plate << " plates minimum" << endl;
   cout << endl;
 }
 
@@ -448,6 +453,8 @@ void SolutionChecker::reportQuality(const Solution &solution) {
   }
   cout << 100.0 * mapped / used << "% density" << endl;
   cout << 100.0 * wasted / used << "% wasted" << endl;
+  if (mapped == total)
+    cout << LowerBound::percentGap(problem_, used) << "% optimality gap" << endl;
   cout << 1.0 * used / plate << " plates used" << endl;
   cout << 1.0 * wasted / plate << " plates wasted" << endl;
   cout << wasted << " objective value" << endl;
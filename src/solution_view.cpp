@@ -0,0 +1,87 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#include "solution_view.hpp"
+
+using namespace std;
+
+SolutionView::SolutionView()
+: valid_(false)
+, hash_(0)
+, itemOffsets_(1, 0)
+, rowOffsets_(1, 0)
+, cutOffsets_(1, 0)
+, plateOffsets_(1, 0) {
+}
+
+SolutionView::SolutionView(const Problem &problem, const Solution &solution) {
+  int nItems = solution.nItems();
+  sequence_.reserve(nItems);
+  itemOffsets_.reserve(nItems + 1);
+
+  for (int i = 0; i < solution.nPlates(); ++i) {
+    const PlateSolution &plate = solution.plates[i];
+    plateOffsets_.push_back(sequence_.size());
+    plates_.push_back(&plate);
+    for (const CutSolution &cut : plate.cuts) {
+      cutOffsets_.push_back(sequence_.size());
+      cuts_.push_back(&cut);
+      cutPlates_.push_back(i);
+      for (const RowSolution &row : cut.rows) {
+        rowOffsets_.push_back(sequence_.size());
+        rows_.push_back(&row);
+        rowPlates_.push_back(i);
+        for (const ItemSolution &item : row.items) {
+          itemOffsets_.push_back(sequence_.size());
+          sequence_.push_back(item.itemId);
+        }
+      }
+    }
+  }
+
+  int end = sequence_.size();
+  itemOffsets_.push_back(end);
+  rowOffsets_.push_back(end);
+  cutOffsets_.push_back(end);
+  plateOffsets_.push_back(end);
+  valid_ = checkValid(problem);
+
+  hash_ = 0;
+  classes_.reserve(sequence_.size());
+  for (int pos = 0; pos < (int) sequence_.size(); ++pos) {
+    hash_ += itemHash(pos, problem.items()[sequence_[pos]]);
+    classes_.push_back(problem.itemClasses()[sequence_[pos]]);
+  }
+}
+
+uint64_t SolutionView::itemHash(int position, const Item &item) {
+  uint64_t h = ((uint64_t) position << 32) | ((uint64_t) (uint16_t) item.width << 16) | (uint16_t) item.height;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+bool SolutionView::checkValid(const Problem &problem) const {
+  if (sequence_.size() != problem.items().size())
+    return false;
+
+  // Item ids are their index in the problem
+  vector<int> itemPositions(problem.items().size(), -1);
+  for (int pos = 0; pos < (int) sequence_.size(); ++pos) {
+    int id = sequence_[pos];
+    if (id < 0 || id >= (int) itemPositions.size() || itemPositions[id] != -1)
+      return false;
+    itemPositions[id] = pos;
+  }
+
+  for (const vector<Item> &stack : problem.stackItems()) {
+    for (unsigned i = 0; i + 1 < stack.size(); ++i) {
+      if (itemPositions[stack[i].id] > itemPositions[stack[i+1].id])
+        return false;
+    }
+  }
+  return true;
+}
+
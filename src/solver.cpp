@@ -4,6 +4,8 @@
 #include "sequence_packer.hpp"
 #include "ordering_heuristic.hpp"
 #include "solution_checker.hpp"
+#include "lower_bound.hpp"
+#include "tracer.hpp"
 
 #include "move.hpp"
 #include "packer_move.hpp"
@@ -14,18 +16,37 @@
 
 using namespace std;
 
-Solution Solver::run(const Problem &problem, SolverParams params, const Solution &initial) {
-  Solver solver(problem, params, initial);
+Solution Solver::run(const Problem &problem, SolverParams params, const Solution &initial, SolverCallbacks callbacks) {
+  Solver solver(problem, params, initial, callbacks);
   solver.run();
   return solver.solution_;
 }
 
-Solver::Solver(const Problem &problem, SolverParams params, const Solution &initial)
+Solution Solver::replay(const Problem &problem, SolverParams params, const Solution &initial, const string &logFile, size_t firstMove, size_t lastMove) {
+  MoveLog log = MoveLog::read(logFile);
+  if (log.nItems != problem.items().size())
+    throw runtime_error("The move log \"" + logFile + "\" was recorded on another problem.");
+  // The recorded outcomes decide which moves are skipped or accepted
+  params.seed = log.seed;
+  params.nbThreads = 1;
+  params.skipKnownSequences = false;
+  params.moveLogFile.clear();
+  params.profileFile.clear();
+  Solver solver(problem, params, initial, SolverCallbacks());
+  solver.replay(log, firstMove, lastMove);
+  return solver.solution_;
+}
+
+Solver::Solver(const Problem &problem, SolverParams params, const Solution &initial, SolverCallbacks callbacks)
 : problem_(problem)
 , params_(params)
+, callbacks_(callbacks)
+, recentSequences_(1 << 12, 0)
 , bestMapped_(0.0)
 , bestDensity_(0.0)
-, nMoves_(0) {
+, densityBound_(LowerBound::percentDensity(problem))
+, nMoves_(0)
+, nBatches_(0) {
 
   vector<size_t> seeds(params_.nbThreads);
   seed_seq seq { params_.seed };
@@ -100,8 +121,14 @@ Solver::Solver(const Problem &problem, SolverParams params, const Solution &init
   addMove(make_unique<PackPlateShuffle>() );
   */
   
-  for (const auto &m : initializers_) m.first->solver_ = this;
-  for (const auto &m : moves_) m.first->solver_ = this;
+  for (const auto &m : initializers_) {
+    m.first->solver_ = this;
+    m.first->traceName_ = Tracer::intern(m.first->name());
+  }
+  for (const auto &m : moves_) {
+    m.first->solver_ = this;
+    m.first->traceName_ = Tracer::intern(m.first->name());
+  }
 
   init(initial);
 }
@@ -120,9 +147,11 @@ void Solver::init(const Solution &solution) {
 
   if (solution.nItems() == 0) return;
 
-  solution_ = solution;
+  setSolution(solution);
   bestDensity_ = SolutionChecker::evalPercentDensity(problem_, solution_);
   bestMapped_ = SolutionChecker::evalPercentMapped(problem_, solution_);
+  if (!params_.profileFile.empty())
+    profile_.add(0, bestMapped_, bestDensity_, "Initial");
 
   if (params_.verbosity >= 2) {
     if (params_.verbosity >= 3) {
@@ -137,27 +166,98 @@ void Solver::init(const Solution &solution) {
 }
 
 void Solver::run() {
-  startTime_ = chrono::system_clock::now();
+  startTime_ = chrono::steady_clock::now();
   nMoves_ = 0;
 
+  auto timeLimit = chrono::duration<double>(0.98 * params_.timeLimit);
+  auto end = startTime_ + chrono::duration_cast<chrono::steady_clock::duration>(timeLimit);
+  const CancellationToken *token = callbacks_.cancellation;
+  // A deadline given by the caller, such as the batch solver's, may end the run earlier
+  if (params_.deadline != nullptr) {
+    end = min(end, params_.deadline->end());
+    if (token == nullptr) token = params_.deadline->token();
+  }
+  deadline_ = Deadline(end, token);
+
   while (nMoves_ < params_.moveLimit) {
-    if (chrono::duration<double>(chrono::system_clock::now() - startTime_).count()
-      > 0.98 * params_.timeLimit)
+    // Late rather than empty: nothing is cancelled until there is a complete solution to return
+    bool hasSolution = solution_.nPlates() != 0;
+    params_.deadline = hasSolution ? &deadline_ : nullptr;
+    if (hasSolution && deadline_.expired())
+      break;
+    if (boundReached()) {
+      if (params_.verbosity >= 2)
+        cout << "Lower bound reached after " << nMoves_ << " moves" << endl;
       break;
+    }
     step();
   }
 
-  endTime_ = chrono::system_clock::now();
+  params_.deadline = nullptr;
+  endTime_ = chrono::steady_clock::now();
+  finalReport();
+
+  if (!params_.moveLogFile.empty()) {
+    moveLog_.seed = params_.seed;
+    moveLog_.nItems = problem_.items().size();
+    moveLog_.write(params_.moveLogFile);
+  }
+  if (!params_.profileFile.empty()) {
+    profile_.add(nMoves_, bestMapped_, bestDensity_, "End");
+    profile_.write(params_.profileFile, params_.timeLimit);
+  }
+}
+
+void Solver::replay(const MoveLog &log, size_t firstMove, size_t lastMove) {
+  startTime_ = chrono::steady_clock::now();
+  const vector<MoveRecord> &records = log.records;
+  for (size_t begin = 0, end = 0; begin < records.size() && records[begin].index < lastMove; begin = end) {
+    end = begin;
+    while (end < records.size() && records[end].batch == records[begin].batch) ++end;
+
+    // Moves of a batch are evaluated from the same solution: those in the range, and those that changed the solution
+    size_t nEvals = end - begin;
+    vector<Solution> incumbents(nEvals);
+    vector<Move*> moves(nEvals, nullptr);
+    for (size_t i = 0; i < nEvals; ++i) {
+      const MoveRecord &record = records[begin + i];
+      MoveStatus recorded = (MoveStatus) record.status;
+      bool changed = recorded == MoveStatus::Improvement || recorded == MoveStatus::Plateau;
+      bool inRange = record.index >= firstMove && record.index < lastMove;
+      if (record.index >= lastMove || !(changed || (inRange && !record.skipped)))
+        continue;
+      mt19937 rgen = moveGenerator(record.index);
+      moves[i] = pickMove(record.index, rgen);
+      if (moves[i] != recordedMove(record.move))
+        throw runtime_error("The move log does not match the options of this run.");
+      incumbents[i] = moves[i]->apply(rgen);
+    }
+
+    // Only the moves that changed the solution are accepted again; the outcome of the others is the recorded one
+    for (size_t i = 0; i < nEvals; ++i) {
+      if (moves[i] == nullptr) continue;
+      const MoveRecord &record = records[begin + i];
+      MoveStatus status = (MoveStatus) record.status;
+      if (status == MoveStatus::Improvement || status == MoveStatus::Plateau) {
+        if (accept(*moves[i], incumbents[i]) != status)
+          throw runtime_error("The replay diverged from the recorded run at move " + to_string(record.index) + ".");
+      }
+      if (record.index >= firstMove)
+        updateStats(*moves[i], status, incumbents[i]);
+      nMoves_ = record.index + 1;
+    }
+  }
+  endTime_ = chrono::steady_clock::now();
   finalReport();
 }
 
-Move* Solver::pickMove() {
+Move* Solver::pickMove(size_t moveIndex, mt19937 &rgen) {
   Move* move;
-  if (nMoves_ < params_.initializationRuns) {
-    return pickMove(initializers_);
+  if (moveIndex < params_.initializationRuns) {
+    return pickMove(initializers_, rgen);
   }
   else {
-    return pickMove(moves_);
+    return pickMove(moves_, rgen);
   }
 
   if (params_.verbosity >= 3) {
@@ -166,12 +266,12 @@ Move* Solver::pickMove() {
   return move;
 }
 
-Move* Solver::pickMove(const vector<pair<unique_ptr<Move>, int> > &moves) {
+Move* Solver::pickMove(const vector<pair<unique_ptr<Move>, int> > &moves, mt19937 &rgen) {
   int totWeight = 0;
   for (const auto& m : moves) totWeight += m.second;
 
   uniform_int_distribution<int> dist(0, totWeight-1);
-  int roll = dist(rgens_[0]);
+  int roll = dist(rgen);
 
   int weight = 0;
   for (const auto& m : moves) {
@@ -182,19 +282,64 @@ Move* Solver::pickMove(const vector<pair<unique_ptr<Move>, int> > &moves) {
   return moves[0].first.get();
 }
 
+void Solver::setSolution(const Solution &solution) {
+  solution_ = solution;
+  view_ = SolutionView(problem_, solution_);
+}
+
+bool Solver::knownSequence(uint64_t hash) const {
+  return hash == view_.hash() || recentSequences_[hash & (recentSequences_.size() - 1)] == hash;
+}
+
+bool Solver::boundReached() const {
+  return params_.stopAtBound && bestMapped_ >= 100.0 && bestDensity_ >= densityBound_;
+}
+
+size_t Solver::spareThreads(size_t parallelEvals) const {
+  // Threads left over by the moves pack the next plates of their packings ahead of time
+  return (params_.nbThreads - parallelEvals) / parallelEvals;
+}
+
+mt19937 Solver::moveGenerator(size_t moveIndex) const {
+  seed_seq seq { params_.seed, moveIndex };
+  return mt19937(seq);
+}
+
 void Solver::step() {
+  Tracer::Span span("Solver::step");
+  if (params_.deterministic) {
+    stepDeterministic();
+    return;
+  }
+
   size_t parallelEvals = min(params_.nbThreads, params_.moveLimit - nMoves_);
+  params_.speculativeThreads = spareThreads(parallelEvals);
   vector<Solution> incumbents(parallelEvals);
+  vector<uint64_t> sequenceHashes(parallelEvals);
+  vector<char> skipped(parallelEvals);
 
-  // Move selection
+  // Move selection; when recording, each move is seeded by its index so that it can be replayed
+  bool recording = !params_.moveLogFile.empty();
+  vector<mt19937> moveRgens;
   vector<Move*> moves(parallelEvals);
   for (size_t i = 0; i < parallelEvals; ++i) {
-    moves[i] = pickMove();
+    if (recording) {
+      moveRgens.push_back(moveGenerator(nMoves_ + i));
+      moves[i] = pickMove(nMoves_ + i, moveRgens[i]);
+    }
+    else {
+      moves[i] = pickMove(nMoves_, rgens_[0]);
+    }
   }
 
   // Parallel evaluation
   auto runner = [&](size_t ind) {
-    incumbents[ind] = moves[ind]->apply(rgens_[ind]);
+    Move::evaluatedHash_ = 0;
+    Move::skippedKnown_ = false;
+    Tracer::Span span(moves[ind]->traceName_, "move");
+    incumbents[ind] = moves[ind]->apply(recording ? moveRgens[ind] : rgens_[ind]);
+    sequenceHashes[ind] = Move::evaluatedHash_;
+    skipped[ind] = Move::skippedKnown_;
   };
   vector<thread> threads;
   for (size_t i = 0; i < parallelEvals; ++i) {
@@ -205,13 +350,70 @@ void Solver::step() {
   }
 
   // Sequential acceptance
+  for (size_t i = 0; i < parallelEvals; ++i) {
+    uint64_t hash = sequenceHashes[i];
+    if (hash != 0)
+      recentSequences_[hash & (recentSequences_.size() - 1)] = hash;
+  }
   for (size_t i = 0; i < parallelEvals; ++i, ++nMoves_) {
     MoveStatus status = accept(*moves[i], incumbents[i]);
     updateStats(*moves[i], status, incumbents[i]);
+    recordMove(nMoves_, *moves[i], status, skipped[i]);
+  }
+  ++nBatches_;
+}
+
+void Solver::stepDeterministic() {
+  // The moves are evaluated in parallel from the same solution, as in step(), but each is seeded by its index.
+  // Once a move changes the solution, the following ones are discarded: they are evaluated again in the next step
+  size_t parallelEvals = min(params_.nbThreads, params_.moveLimit - nMoves_);
+  params_.speculativeThreads = spareThreads(parallelEvals);
+  vector<Solution> incumbents(parallelEvals);
+  vector<uint64_t> sequenceHashes(parallelEvals);
+  vector<char> skipped(parallelEvals);
+  vector<mt19937> rgens;
+  vector<Move*> moves(parallelEvals);
+  for (size_t i = 0; i < parallelEvals; ++i) {
+    rgens.push_back(moveGenerator(nMoves_ + i));
+    moves[i] = pickMove(nMoves_ + i, rgens[i]);
+  }
+
+  auto runner = [&](size_t ind) {
+    Move::evaluatedHash_ = 0;
+    Move::skippedKnown_ = false;
+    Tracer::Span span(moves[ind]->traceName_, "move");
+    incumbents[ind] = moves[ind]->apply(rgens[ind]);
+    sequenceHashes[ind] = Move::evaluatedHash_;
+    skipped[ind] = Move::skippedKnown_;
+  };
+  vector<thread> threads;
+  for (size_t i = 0; i < parallelEvals; ++i) {
+    threads.push_back(thread(runner, i));
+  }
+  for (size_t i = 0; i < parallelEvals; ++i) {
+    threads[i].join();
   }
+
+  Solution noSolution;
+  for (size_t i = 0; i < parallelEvals; ++i) {
+    // Sequence evaluated earlier in this step: a sequential run would have skipped it
+    uint64_t hash = sequenceHashes[i];
+    bool known = hash != 0 && knownSequence(hash);
+    if (hash != 0 && !known)
+      recentSequences_[hash & (recentSequences_.size() - 1)] = hash;
+    const Solution &incumbent = known ? noSolution : incumbents[i];
+    MoveStatus status = accept(*moves[i], incumbent);
+    updateStats(*moves[i], status, incumbent);
+    recordMove(nMoves_, *moves[i], status, known || skipped[i]);
+    ++nMoves_;
+    if (status == MoveStatus::Improvement || status == MoveStatus::Plateau)
+      break;
+  }
+  ++nBatches_;
 }
 
 Solver::MoveStatus Solver::accept(Move &move, const Solution &incumbent) {
+  Tracer::Span span("Solver::accept");
   if (incumbent.nPlates() == 0) {
     if (params_.verbosity >= 3) {
       cout << "No solution found by " << move.name() << endl;
@@ -246,7 +448,6 @@ Solver::MoveStatus Solver::accept(Move &move, const Solution &incumbent) {
     status = MoveStatus::Degradation;
   }
   else if (density > prevDensity) {
-    solution_ = incumbent;
     status = MoveStatus::Improvement;
   }
   else if (density < prevDensity) {
@@ -267,12 +468,17 @@ Solver::MoveStatus Solver::accept(Move &move, const Solution &incumbent) {
   else if (status == MoveStatus::Improvement && params_.verbosity >= 2) {
     cout << density << "%\t" << nMoves_ << "\t" << move.name() << endl;
   }
+  if (status == MoveStatus::Improvement && !params_.profileFile.empty())
+    profile_.add(nMoves_, mapped, density, move.name());
 
   if (status != MoveStatus::Degradation) {
-    solution_ = incumbent;
+    setSolution(incumbent);
     bestMapped_ = mapped;
     bestDensity_ = density;
   }
+
+  if (status == MoveStatus::Improvement && callbacks_.onImprovement)
+    callbacks_.onImprovement(solution_);
   
   return status;
 }
@@ -298,30 +504,34 @@ void Solver::updateStats(Move &move, MoveStatus status, const Solution &incumben
       break;
   }
 
-  vector<Item> oldSequence = solution_.sequence(problem_);
-  vector<Item> newSequence = incumbent.sequence(problem_);
-
-  int beginDiff = 0;
-  for (; beginDiff < (int) newSequence.size(); ++beginDiff) {
-    int ind = beginDiff;
-    if (ind < (int) oldSequence.size()
-     && oldSequence[ind].id != newSequence[ind].id) break;
-  }
-  int endDiff = newSequence.size();
-  for (; endDiff > 0; --endDiff) {
-    int ind = endDiff - 1;
-    if (ind < (int) oldSequence.size()
-     && oldSequence[ind].id != newSequence[ind].id) break;
+  // First and last positions where the incumbent differs from the current solution
+  const vector<int> &oldSequence = view_.sequence();
+  int nItems = incumbent.nItems();
+  int firstDiff = nItems;
+  int lastDiff = -1;
+  int ind = 0;
+  for (const PlateSolution &plate : incumbent.plates) {
+    for (const CutSolution &cut : plate.cuts) {
+      for (const RowSolution &row : cut.rows) {
+        for (const ItemSolution &item : row.items) {
+          if (ind < (int) oldSequence.size() && oldSequence[ind] != item.itemId) {
+            firstDiff = min(firstDiff, ind);
+            lastDiff = ind;
+          }
+          ++ind;
+        }
+      }
+    }
   }
-  if (endDiff == 0) endDiff = newSequence.size();
+  int beginDiff = firstDiff;
+  int endDiff = lastDiff >= 0 ? lastDiff + 1 : nItems;
 
-  int foundSolutionItems = 0;
   int foundIncumbentItems = 0;
   int nCommonPlates = 0;
   int nPrunedPlates = 0;
   for (int i = 0; i < incumbent.nPlates() && i < solution_.nPlates(); ++i) {
-    foundSolutionItems += solution_.plates[i].nItems();
-    foundIncumbentItems += incumbent.plates[i].nItems();
+    int foundSolutionItems = view_.plateOffsets()[i + 1];
+    foundIncumbentItems += incumbent.plates[i]->nItems();
     if (foundSolutionItems <= beginDiff) {
       nCommonPlates = i;
     }
@@ -342,6 +552,37 @@ void Solver::updateStats(Move &move, MoveStatus status, const Solution &incumben
   move.nDifferentPlates_ += incumbent.nPlates() - nCommonPlates - nPrunedPlates;
 }
 
+void Solver::recordMove(size_t moveIndex, const Move &move, MoveStatus status, bool skipped) {
+  if (params_.moveLogFile.empty()) return;
+  int id = 0;
+  for (const auto &m : initializers_) {
+    if (m.first.get() == &move) break;
+    ++id;
+  }
+  if (id == (int) initializers_.size()) {
+    for (const auto &m : moves_) {
+      if (m.first.get() == &move) break;
+      ++id;
+    }
+  }
+  MoveRecord record;
+  record.index = moveIndex;
+  record.batch = nBatches_;
+  record.move = id;
+  record.status = (uint8_t) status;
+  record.skipped = skipped;
+  moveLog_.records.push_back(record);
+}
+
+Move* Solver::recordedMove(int id) const {
+  if (id < (int) initializers_.size())
+    return initializers_[id].first.get();
+  id -= initializers_.size();
+  if (id < (int) moves_.size())
+    return moves_[id].first.get();
+  return nullptr;
+}
+
 void Solver::finalReport() const {
   if (params_.verbosity >= 2) {
     int nEvaluated = 0;
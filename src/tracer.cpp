@@ -0,0 +1,118 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#include "tracer.hpp"
+
+#include <vector>
+#include <set>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+using namespace std;
+
+atomic<bool> Tracer::enabled_(false);
+
+namespace {
+struct Event {
+  const char *name;
+  const char *category;
+  int64_t begin;
+  int64_t end;
+};
+
+struct Lane {
+  vector<Event> events;
+  size_t nEvents;
+  bool busy;
+};
+
+mutex lanesMutex;
+vector<unique_ptr<Lane> > lanes;
+size_t laneCapacity = 0;
+chrono::steady_clock::time_point epoch;
+set<string> names;
+
+// Lane of the thread, taken at its first span and given back to the pool when it exits
+struct LaneHandle {
+  Lane *lane = nullptr;
+  ~LaneHandle() {
+    if (lane == nullptr) return;
+    lock_guard<mutex> lock(lanesMutex);
+    lane->busy = false;
+  }
+};
+thread_local LaneHandle currentLane;
+
+Lane &acquireLane() {
+  lock_guard<mutex> lock(lanesMutex);
+  for (unique_ptr<Lane> &lane : lanes) {
+    if (!lane->busy) {
+      lane->busy = true;
+      return *lane;
+    }
+  }
+  lanes.emplace_back(new Lane{vector<Event>(laneCapacity), 0, true});
+  return *lanes.back();
+}
+}
+
+void Tracer::enable(size_t capacity) {
+  if (capacity == 0) throw runtime_error("The trace must keep at least one span per thread.");
+  {
+    lock_guard<mutex> lock(lanesMutex);
+    laneCapacity = capacity;
+    epoch = chrono::steady_clock::now();
+  }
+  // The calling thread gets the first line of the timeline
+  if (currentLane.lane == nullptr)
+    currentLane.lane = &acquireLane();
+  enabled_.store(true, memory_order_relaxed);
+}
+
+const char *Tracer::intern(const string &name) {
+  lock_guard<mutex> lock(lanesMutex);
+  return names.insert(name).first->c_str();
+}
+
+int64_t Tracer::now() {
+  return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - epoch).count();
+}
+
+void Tracer::record(const char *name, const char *category, int64_t begin, int64_t end) {
+  if (currentLane.lane == nullptr)
+    currentLane.lane = &acquireLane();
+  Lane &lane = *currentLane.lane;
+  lane.events[lane.nEvents % lane.events.size()] = Event{name, category, begin, end};
+  ++lane.nEvents;
+}
+
+void Tracer::write(const string &fileName) {
+  ofstream f(fileName);
+  if (f.fail())
+    throw runtime_error("Couldn't open file \"" + fileName + "\".");
+
+  lock_guard<mutex> lock(lanesMutex);
+  f << fixed << setprecision(3);
+  f << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << endl;
+  bool first = true;
+  for (size_t tid = 0; tid < lanes.size(); ++tid) {
+    const Lane &lane = *lanes[tid];
+    if (!first) f << "," << endl;
+    first = false;
+    f << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << tid << ",\"args\":{\"name\":\"thread " << tid << "\"}}";
+    // Oldest first, when the buffer has wrapped around
+    size_t capacity = lane.events.size();
+    size_t begin = lane.nEvents > capacity ? lane.nEvents - capacity : 0;
+    for (size_t i = begin; i < lane.nEvents; ++i) {
+      const Event &e = lane.events[i % capacity];
+      f << "," << endl;
+      f << "{\"name\":\"" << e.name << "\",\"cat\":\"" << e.category << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << tid;
+      f << ",\"ts\":" << e.begin / 1000.0 << ",\"dur\":" << (e.end - e.begin) / 1000.0 << "}";
+    }
+  }
+  f << endl << "]}" << endl;
+}
+
@@ -0,0 +1,216 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#include "window_solver.hpp"
+#include "sequence_packer.hpp"
+#include "solution_checker.hpp"
+#include "lower_bound.hpp"
+
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <map>
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+// Shortest round, so that each window gets at least a few moves
+constexpr double minSlice = 0.01;
+// Share of the time limit spent on the whole problem when there is no initial solution
+constexpr double initialShare = 0.25;
+// Rounds between two stitchings, so that the boundaries move several times within the time limit
+constexpr double roundShare = 0.125;
+}
+
+Solution WindowSolver::run(const Problem &problem, SolverParams params, const Solution &initial, SolverCallbacks callbacks) {
+  WindowSolver solver(problem, params, callbacks);
+  solver.run(initial);
+  return solver.solution_;
+}
+
+WindowSolver::WindowSolver(const Problem &problem, SolverParams params, SolverCallbacks callbacks)
+: problem_(problem)
+, params_(params)
+, callbacks_(callbacks)
+, mapped_(0.0)
+, density_(0.0)
+, densityBound_(LowerBound::percentDensity(problem)) {
+  if (params_.windowPlates == 0) throw runtime_error("Windows must contain at least one plate.");
+}
+
+WindowSolver::Window WindowSolver::extract(const Problem &problem, const Solution &solution, int firstPlate, int lastPlate) {
+  Solution windowSolution;
+  windowSolution.plates.assign(solution.plates.begin() + firstPlate, solution.plates.begin() + lastPlate);
+
+  vector<Item> items;
+  vector<int> itemIds;
+  for (Cow<PlateSolution> &plate : windowSolution.plates) {
+    for (CutSolution &cut: plate.mut().cuts) {
+      for (RowSolution &row: cut.rows) {
+        for (ItemSolution &isol: row.items) {
+          Item item = problem.items()[isol.itemId];
+          itemIds.push_back(isol.itemId);
+          item.id = items.size();
+          isol.itemId = item.id;
+          items.push_back(item);
+        }
+      }
+    }
+  }
+
+  // Keep the defects of the following plates, in case the window needs more plates
+  vector<Defect> defects;
+  for (Defect defect : problem.defects()) {
+    if (defect.plateId < firstPlate) continue;
+    defect.plateId -= firstPlate;
+    defects.push_back(defect);
+  }
+
+  int stackId = 0;
+  map<int, int> stackIdMapping;
+  for (Item &item : items) {
+    if (!stackIdMapping.count(item.stack))
+      stackIdMapping.emplace(item.stack, stackId++);
+    item.stack = stackIdMapping[item.stack];
+  }
+
+  return Window{Problem(items, defects, problem.nPlates() - firstPlate), windowSolution, itemIds};
+}
+
+void WindowSolver::run(const Solution &initial) {
+  startTime_ = chrono::steady_clock::now();
+
+  if (initial.nItems() != 0 && SolutionChecker::evalPercentMapped(problem_, initial) > 99.9) {
+    accept(initial);
+  }
+  else {
+    // The windows are taken from a complete solution: obtain one on the whole problem first
+    SolverParams params = params_;
+    params.timeLimit = initialShare * params_.timeLimit;
+    params.moveLogFile.clear();
+    params.profileFile.clear();
+    accept(Solver::run(problem_, params, initial, callbacks_));
+  }
+  if (!params_.profileFile.empty())
+    profile_.add(0, mapped_, density_, "Initial");
+
+  int round = 0;
+  for (; remainingTime() > minSlice; ++round) {
+    if (callbacks_.cancellation && callbacks_.cancellation->cancelled())
+      break;
+    if (params_.stopAtBound && mapped_ >= 100.0 && density_ >= densityBound_)
+      break;
+    runRound(round, max(minSlice, min(roundShare * params_.timeLimit, remainingTime())));
+  }
+
+  if (!params_.profileFile.empty()) {
+    profile_.add(round, mapped_, density_, "End");
+    profile_.write(params_.profileFile, params_.timeLimit);
+  }
+}
+
+vector<int> WindowSolver::windowBoundaries(int round) const {
+  // Every other round, the boundaries are shifted by half a window
+  int nPlates = solution_.nPlates();
+  int windowPlates = params_.windowPlates;
+  vector<int> boundaries = {0};
+  for (int b = round % 2 == 0 ? windowPlates : windowPlates / 2; b < nPlates; b += windowPlates) {
+    if (b > 0) boundaries.push_back(b);
+  }
+  boundaries.push_back(nPlates);
+  return boundaries;
+}
+
+void WindowSolver::runRound(int round, double slice) {
+  vector<int> boundaries = windowBoundaries(round);
+  vector<Window> windows;
+  for (size_t i = 0; i + 1 < boundaries.size(); ++i) {
+    windows.push_back(extract(problem_, solution_, boundaries[i], boundaries[i+1]));
+  }
+  int nWindows = windows.size();
+
+  // Same split of the threads as the batch solver: one worker per window at most, the leftover threads to the first workers
+  size_t nWorkers = max((size_t) 1, min(params_.nbThreads, (size_t) nWindows));
+  double windowSlice = max(minSlice, slice * nWorkers / nWindows);
+
+  vector<Solution> results(nWindows);
+  atomic<int> nextWindow(0);
+  auto worker = [&](size_t nThreads) {
+    for (int i = nextWindow++; i < nWindows; i = nextWindow++) {
+      SolverParams params = params_;
+      params.seed = params_.seed + round * nWindows + i;
+      params.nbThreads = nThreads;
+      params.timeLimit = windowSlice;
+      params.initializationRuns = 0;
+      params.speculativeThreads = 0;
+      params.verbosity = max(0, params_.verbosity - 2);
+      params.moveLogFile.clear();
+      params.profileFile.clear();
+      SolverCallbacks callbacks;
+      callbacks.cancellation = callbacks_.cancellation;
+      results[i] = Solver::run(windows[i].problem, params, windows[i].solution, callbacks);
+    }
+  };
+  vector<thread> workers;
+  for (size_t i = 0; i < nWorkers; ++i) {
+    size_t nThreads = max((size_t) 1, params_.nbThreads / nWorkers + (i < params_.nbThreads % nWorkers ? 1 : 0));
+    workers.push_back(thread(worker, nThreads));
+  }
+  for (thread &w : workers) {
+    w.join();
+  }
+
+  // Stitch the windows in order and pack again, since the plates of a window may have moved
+  vector<int> sequence;
+  for (int i = 0; i < nWindows; ++i) {
+    for (int id : results[i].sequence()) {
+      sequence.push_back(windows[i].itemIds[id]);
+    }
+  }
+  vector<Item> items = problem_.itemSequence(sequence);
+  // Bounded by the time limit: a cancelled packing is empty and the incumbent is kept
+  auto remaining = chrono::duration<double>(max(0.0, remainingTime()));
+  Deadline deadline(chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(remaining), callbacks_.cancellation);
+  SolverParams params = params_;
+  params.deadline = &deadline;
+  // The other threads are idle during the stitching: they pack the next plates speculatively
+  params.speculativeThreads = params_.nbThreads - 1;
+  bool improved = accept(SequencePacker::run(problem_, items, params, solution_));
+
+  if (improved && params_.verbosity >= 2) {
+    cout << density_ << "%\t" << round << "\tWindows" << endl;
+  }
+  if (improved && !params_.profileFile.empty())
+    profile_.add(round + 1, mapped_, density_, "Windows");
+}
+
+bool WindowSolver::accept(const Solution &solution) {
+  if (solution.nPlates() == 0) return false;
+  if (SolutionChecker::nViolations(problem_, solution) != 0) {
+    if (params_.failOnViolation) {
+      solution.write("invalid_solution.csv");
+      throw runtime_error("Stitching the windows returned an invalid solution.");
+    }
+    return false;
+  }
+
+  double mapped = SolutionChecker::evalPercentMapped(problem_, solution);
+  double density = SolutionChecker::evalPercentDensity(problem_, solution);
+  bool first = solution_.nPlates() == 0;
+  if (!first && (mapped < mapped_ || (mapped == mapped_ && density < density_)))
+    return false;
+
+  bool improved = mapped > mapped_ || density > density_;
+  solution_ = solution;
+  mapped_ = mapped;
+  density_ = density;
+  if (!first && improved && callbacks_.onImprovement)
+    callbacks_.onImprovement(solution_);
+  return improved;
+}
+
+double WindowSolver::remainingTime() const {
+  double elapsed = chrono::duration<double>(chrono::steady_clock::now() - startTime_).count();
+  return 0.98 * params_.timeLimit - elapsed;
+}
+
@@ -0,0 +1,204 @@
+// Copyright (C) 2019 Gabriel Gouvine - All Rights Reserved
+
+#include "problem.hpp"
+#include "utils.hpp"
+
+#include <iostream>
+#include <random>
+#include <boost/program_options.hpp>
+
+/*
+ * Random instance generator, for stress tests beyond the size of the challenge instances
+ *
+ * Same model as utils/generator.py, with every setting on the command line.
+ * The output only depends on the options and the seed.
+ */
+
+using namespace std;
+namespace po = boost::program_options;
+
+struct GeneratorParams {
+  int nStacks;
+  int avgStackSize;
+  int nPlates;
+  int avgDefects;
+  double largeItemRatio;
+  double borderDefectRatio;
+  double noDefectRatio;
+  bool regular;
+};
+
+class Generator {
+ public:
+  static Problem run(const GeneratorParams &params, size_t seed);
+
+ private:
+  Generator(const GeneratorParams &params, size_t seed);
+  void generateItems();
+  void generateDefects();
+
+  Item generateItem();
+  Item generateSizedItem(int minSize, int maxSize);
+  Defect generateDefect();
+  Defect generateBorderDefect();
+  bool validItem(const Item &item) const;
+
+  int randint(int a, int b) { return uniform_int_distribution<int>(a, b)(rgen_); }
+  double random() { return uniform_real_distribution<double>(0.0, 1.0)(rgen_); }
+
+ private:
+  GeneratorParams params_;
+  mt19937 rgen_;
+  vector<Item> items_;
+  vector<Defect> defects_;
+};
+
+Problem Generator::run(const GeneratorParams &params, size_t seed) {
+  Generator generator(params, seed);
+  generator.generateItems();
+  generator.generateDefects();
+  return Problem(generator.items_, generator.defects_);
+}
+
+Generator::Generator(const GeneratorParams &params, size_t seed)
+: params_(params)
+, rgen_(seed) {
+}
+
+void Generator::generateItems() {
+  for (int stack = 0; stack < params_.nStacks; ++stack) {
+    int nItems = randint(1, 2 * params_.avgStackSize - 1);
+    Item item = generateItem();
+    for (int i = 0; i < nItems; ++i) {
+      if (!params_.regular && i > 0)
+        item = generateItem();
+      item.id = items_.size();
+      item.stack = stack;
+      item.sequence = i + 1;
+      items_.push_back(item);
+    }
+  }
+}
+
+void Generator::generateDefects() {
+  for (int plate = 0; plate < params_.nPlates; ++plate) {
+    // Beyond the challenge's plates, the solver counts the plates from the defects: the last one always has some
+    bool last = plate == params_.nPlates - 1 && params_.nPlates > Params::nPlates;
+    if (random() < params_.noDefectRatio && !last)
+      continue;
+    int nDefects = randint(1, 2 * params_.avgDefects);
+    for (int i = 0; i < nDefects; ++i) {
+      Defect defect = random() < params_.borderDefectRatio ? generateBorderDefect() : generateDefect();
+      defect.id = defects_.size();
+      defect.plateId = plate;
+      defects_.push_back(defect);
+    }
+  }
+}
+
+Item Generator::generateItem() {
+  if (random() < params_.largeItemRatio)
+    return generateSizedItem(Params::minXX, Params::maxXX);
+  else
+    return generateSizedItem(Params::minWaste, 8 * Params::minXX);
+}
+
+Item Generator::generateSizedItem(int minSize, int maxSize) {
+  while (true) {
+    int a = randint(minSize, maxSize);
+    int b = randint(minSize, maxSize);
+    Item item;
+    item.width = min(a, b);
+    item.height = max(a, b);
+    if (validItem(item))
+      return item;
+  }
+}
+
+bool Generator::validItem(const Item &item) const {
+  if (item.width < Params::minWaste)
+    return false;
+  if (item.height > Params::maxXX)
+    return false;
+  return utils::fitsMinWaste(item.width, Params::heightPlates)
+      || utils::fitsMinWaste(item.height, Params::heightPlates);
+}
+
+Defect Generator::generateDefect() {
+  int width = randint(1, 20);
+  int height = randint(1, 20);
+  int x = randint(0, Params::widthPlates - width);
+  int y = randint(0, Params::heightPlates - height);
+  return Defect(x, y, width, height);
+}
+
+Defect Generator::generateBorderDefect() {
+  Defect defect = generateDefect();
+  int x = defect.minX();
+  int y = defect.minY();
+  double val = random();
+  if (val < 0.25)
+    x = 0;
+  else if (val < 0.5)
+    y = 0;
+  else if (val < 0.75)
+    x = Params::widthPlates - defect.width();
+  else
+    y = Params::heightPlates - defect.height();
+  return Defect(x, y, defect.width(), defect.height());
+}
+
+int main(int argc, char **argv) {
+  po::options_description desc("Instance generator options");
+  desc.add_options()("o", po::value<string>(), "Instance name; will write <arg>_batch.csv and <arg>_defects.csv");
+  desc.add_options()("s", po::value<size_t>()->default_value(0), "Random seed");
+  desc.add_options()("stacks", po::value<int>()->default_value(10), "Number of stacks");
+  desc.add_options()("stack-size", po::value<int>()->default_value(30), "Average number of items per stack");
+  desc.add_options()("plates", po::value<int>()->default_value(Params::nPlates), "Number of plates; beyond the challenge's limit, the instance has as many plates as the plates with defects");
+  desc.add_options()("defects", po::value<int>()->default_value(10), "Average number of defects per plate");
+  desc.add_options()("large-items", po::value<double>()->default_value(0.0), "Ratio of large items");
+  desc.add_options()("border-defects", po::value<double>()->default_value(0.2), "Ratio of defects on the border of the plates");
+  desc.add_options()("no-defects", po::value<double>()->default_value(0.2), "Ratio of plates without defects");
+  desc.add_options()("irregular", "Generate different items within a stack");
+  desc.add_options()("help", "Print this help");
+
+  po::variables_map vm;
+  try {
+    int style = po::command_line_style::unix_style | po::command_line_style::allow_long_disguise;
+    po::store(po::parse_command_line(argc, argv, desc, style), vm);
+    po::notify(vm);
+  } catch (po::error &e) {
+    cerr << "Error parsing command line arguments: " << e.what() << endl << endl;
+    cout << desc << endl;
+    return 1;
+  }
+  if (vm.count("help") || !vm.count("o")) {
+    cout << desc << endl;
+    return vm.count("help") ? 0 : 1;
+  }
+
+  GeneratorParams params;
+  params.nStacks = vm["stacks"].as<int>();
+  params.avgStackSize = vm["stack-size"].as<int>();
+  params.nPlates = vm["plates"].as<int>();
+  params.avgDefects = vm["defects"].as<int>();
+  params.largeItemRatio = vm["large-items"].as<double>();
+  params.borderDefectRatio = vm["border-defects"].as<double>();
+  params.noDefectRatio = vm["no-defects"].as<double>();
+  params.regular = !vm.count("irregular");
+
+  if (params.nStacks < 1 || params.avgStackSize < 1 || params.nPlates < 0 || params.avgDefects < 1) {
+    cerr << "Stacks, stack size and defects must be positive" << endl;
+    return 1;
+  }
+
+  try {
+    Problem problem = Generator::run(params, vm["s"].as<size_t>());
+    string prefix = vm["o"].as<string>();
+    problem.write(prefix + "_batch.csv", prefix + "_defects.csv");
+  } catch (const exception &e) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+  return 0;
+}
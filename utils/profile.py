@@ -0,0 +1,96 @@
+#!/usr/bin/python3
+
+"""
+Average the anytime profiles written with --profile over seeds and instances
+
+Profiles are named INSTANCE_SEED.csv (or .json), for example:
+    for s in 0 1 2; do
+      ./challengeSG -p dataset/B/B9 -t 180 -s $s --profile profiles/B9_$s.csv
+    done
+    utils/profile.py profiles/*.csv
+
+The density at a time is the one of the last improvement before it. It is
+only known until the time limit of the run, or the end of the run if it went
+on longer; a star marks densities of solutions that did not map all items.
+"""
+
+import argparse
+import csv
+import json
+import os
+import re
+import sys
+from collections import defaultdict
+
+def read_profile(path):
+    """Points of the profile and the time limit of the run"""
+    if path.endswith(".json"):
+        with open(path) as f:
+            profile = json.load(f)
+        return profile["points"], float(profile["time_limit"])
+    with open(path) as f:
+        points = list(csv.DictReader(f))
+    return points, float(points[-1]["time_limit"]) if points else 0.0
+
+def instance_name(path):
+    name = os.path.splitext(os.path.basename(path))[0]
+    return re.sub(r"_\d+$", "", name)
+
+def value_at(run, time, clock):
+    """(mapped, density) at the given time, or None if the run ended before"""
+    points, time_limit = run
+    if not points:
+        return None
+    # The solver stops slightly before its time limit: the last point holds until then
+    end = float(points[-1][clock])
+    if clock == "wall_time":
+        end = max(end, time_limit)
+    if end < time:
+        return None
+    value = None
+    for p in points:
+        if float(p[clock]) > time:
+            break
+        value = (float(p["mapped"]), float(p["density"]))
+    return value
+
+def mean(values):
+    return sum(values) / len(values)
+
+def format_value(values):
+    if not values or None in values:
+        return "-"
+    text = "%.2f%%" % mean([v[1] for v in values])
+    if any(v[0] < 99.9 for v in values):
+        text += "*"
+    return text
+
+parser = argparse.ArgumentParser(description="Average anytime profiles over seeds and instances")
+parser.add_argument("profiles", nargs="+", help="Profiles named INSTANCE_SEED.csv or INSTANCE_SEED.json")
+parser.add_argument("--times", type=float, nargs="+", default=[3, 30, 180], help="Times at which to report the density")
+parser.add_argument("--cpu", action="store_true", help="Use the CPU time instead of the wall time")
+args = parser.parse_args()
+
+clock = "cpu_time" if args.cpu else "wall_time"
+runs = defaultdict(list)
+for path in args.profiles:
+    runs[instance_name(path)].append(read_profile(path))
+
+print("Instance\tRuns\t" + "\t".join("%gs" % t for t in args.times))
+instance_means = defaultdict(list)
+for name in sorted(runs):
+    row = [name, str(len(runs[name]))]
+    for t in args.times:
+        values = [value_at(run, t, clock) for run in runs[name]]
+        row.append(format_value(values))
+        if values and None not in values:
+            instance_means[t].append((min(v[0] for v in values), mean([v[1] for v in values])))
+        else:
+            instance_means[t].append(None)
+    print("\t".join(row))
+
+if len(runs) > 1:
+    row = ["Mean", str(sum(len(r) for r in runs.values()))]
+    for t in args.times:
+        row.append(format_value(instance_means[t]))
+    print("\t".join(row))